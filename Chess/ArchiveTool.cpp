@@ -0,0 +1,85 @@
+#include "GameArchive.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+
+/**
+ * Checks a binary game archive by replaying every game, and measures how quickly games can be looked up
+ * at random through the index. Given a game number, prints that game as PGN.
+ *
+ * Usage:
+ *   archive <file> [game number]
+ *
+ * @return: 0 if every game replayed legally, 1 otherwise.
+ */
+int main(int argc, char* argv[])
+{
+	if (argc < 2)
+	{
+		cout << "Usage: archive <file> [game number]" << endl;
+		return 1;
+	}
+	GameArchive archive;
+	if (!archive.Open(argv[1]))
+	{
+		cout << "Could not open the archive " << argv[1] << endl;
+		return 1;
+	}
+
+	if (argc >= 3)
+	{
+		PgnGame game;
+		if (!archive.ToPgn(std::strtoull(argv[2], nullptr, 10), game))
+		{
+			cout << "There is no game " << argv[2] << endl;
+			return 1;
+		}
+		WritePgnGame(cout, game);
+		cout.flush();
+		return 0;
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	ChessBoard chess_board;
+	uint64_t plies = 0;
+	uint64_t bad_games = 0;
+	for (uint64_t number = 0; number < archive.GetGameCount(); number++)
+	{
+		ArchivedGame game;
+		bool replayed = archive.GetGame(number, game) && archive.Replay(number, chess_board);
+		// With hashes stored, the final position must also match.
+		if (replayed && game.hashes != nullptr && game.GetHash(game.ply_count) != chess_board.GetHash())
+		{
+			replayed = false;
+		}
+		if (!replayed && bad_games++ < 10)
+		{
+			cout << "Game " << number << " does not replay" << endl;
+		}
+		plies += game.ply_count;
+	}
+	double replay_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	// Look up games at random, reading one move of each so the lookup cannot be skipped.
+	const int kLookups = 1000000;
+	std::mt19937_64 random(1);
+	uint64_t checksum = 0;
+	start = std::chrono::steady_clock::now();
+	for (int i = 0; i < kLookups && archive.GetGameCount() > 0; i++)
+	{
+		ArchivedGame game;
+		if (archive.GetGame(random() % archive.GetGameCount(), game) && game.ply_count > 0)
+		{
+			checksum += game.GetMove(game.ply_count - 1).GetData();
+		}
+	}
+	double lookup_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	cout << archive.GetGameCount() << " games, " << plies << " plies" << (archive.GetHasHashes() ? ", with hashes" : "")
+		<< ", " << bad_games << " do not replay\n"
+		<< "Replayed every game in " << replay_time << " s\n"
+		<< kLookups << " random lookups in " << lookup_time << " s (checksum " << checksum << ")" << endl;
+	return bad_games == 0 ? 0 : 1;
+}
@@ -0,0 +1,132 @@
+#include "ChessGame.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+using std::string;
+#include <thread>
+#include <vector>
+using std::vector;
+
+/**
+ * Positions for the benchmark, each given as the moves played from the start position. They cover
+ * a few common openings so that the search sees more than one kind of position.
+ */
+static const vector<string> kBenchPositions = {
+	"",
+	"e2e4 e7e5 g1f3 b8c6 f1b5 a7a6 b5a4 g8f6 e1g1 f8e7",
+	"d2d4 g8f6 c2c4 e7e6 b1c3 f8b4 e2e3 e8g8",
+	"e2e4 c7c5 g1f3 d7d6 d2d4 c5d4 f3d4 g8f6 b1c3 a7a6",
+	"e2e4 e7e6 d2d4 d7d5 b1c3 g8f6 c1g5 f8e7 e4e5 f6d7",
+	"d2d4 d7d5 c2c4 c7c6 g1f3 g8f6 b1c3 d5c4 a2a4 c8f5",
+};
+
+/**
+ * Plays a list of moves in coordinate notation from the start position.
+ *
+ * @param chess_board: The board to set up
+ * @param moves: The moves, separated by spaces
+ * @return: True if every move was legal, false otherwise.
+ */
+static bool PlayMoves(ChessBoard& chess_board, const string& moves)
+{
+	chess_board.Reset();
+	std::istringstream stream(moves);
+	string text;
+	while (stream >> text)
+	{
+		Move move = ParseMove(chess_board, text.c_str());
+		if (move == Move())
+		{
+			return false;
+		}
+		chess_board.MakeMove(move);
+	}
+	return true;
+}
+
+/**
+ * Searches every benchmark position to a fixed depth with the given number of threads. Each position starts
+ * with an empty transposition table, so every run does the same work.
+ *
+ * @param game: The game to search with
+ * @param threads: The number of search threads
+ * @param depth: The depth to search each position to
+ * @param nodes: Set to the number of nodes searched
+ * @return: The total time to reach the depth on every position, in seconds.
+ */
+static double RunBench(ChessGame& game, int threads, int depth, uint64_t& nodes)
+{
+	game.SetThreads(threads, true);
+	SearchLimits limits;
+	limits.max_depth = depth;
+	nodes = 0;
+	double total_time = 0;
+	for (const string& moves : kBenchPositions)
+	{
+		if (!PlayMoves(game.GetBoard(), moves))
+		{
+			cout << "Illegal move in benchmark position " << moves << endl;
+			continue;
+		}
+		game.ClearHash();
+		auto start = std::chrono::steady_clock::now();
+		SearchResult result = game.FindBestMove(limits);
+		total_time += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		nodes += result.nodes;
+	}
+	return total_time;
+}
+
+/**
+ * Measures how the search scales with threads: the time to reach a fixed depth on a set of positions,
+ * with 1, 2, 4 ... threads up to the given count.
+ *
+ * Usage:
+ *   bench [depth] [threads] [hash MB]
+ *
+ * @return: 0
+ */
+int main(int argc, char* argv[])
+{
+	int depth = argc >= 2 ? std::atoi(argv[1]) : 7;
+	int max_threads = argc >= 3 ? std::atoi(argv[2]) : static_cast<int>(std::thread::hardware_concurrency());
+	int hash_mb = argc >= 4 ? std::atoi(argv[3]) : 64;
+	if (depth < 1 || depth > kMaxSearchDepth)
+	{
+		depth = 7;
+	}
+	if (max_threads < 1)
+	{
+		max_threads = 1;
+	}
+
+	ChessGame game;
+	if (!game.SetHashSize(hash_mb, true))
+	{
+		cout << "Could not allocate a " << hash_mb << " MB transposition table" << endl;
+		return 1;
+	}
+	cout << "Depth " << depth << ", " << kBenchPositions.size() << " positions, " << hash_mb << " MB hash\n";
+	double single_thread_time = 0;
+	for (int threads = 1; ; threads *= 2)
+	{
+		threads = threads < max_threads ? threads : max_threads;
+		uint64_t nodes = 0;
+		double elapsed = RunBench(game, threads, depth, nodes);
+		if (threads == 1)
+		{
+			single_thread_time = elapsed;
+		}
+		cout << "Threads " << threads << ": " << elapsed << " s, " << nodes << " nodes, "
+			<< static_cast<uint64_t>(nodes / (elapsed > 0 ? elapsed : 1e-9)) << " nodes/s, time to depth speedup "
+			<< single_thread_time / (elapsed > 0 ? elapsed : 1e-9) << endl;
+		if (threads == max_threads)
+		{
+			break;
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,200 @@
+#include "Bitboard.h"
+
+static constexpr int kKnightOffsets[8][2] = { {-2, -1}, {-2, 1}, {-1, -2}, {-1, 2}, {1, -2}, {1, 2}, {2, -1}, {2, 1} };
+static constexpr int kKingOffsets[8][2] = { {-1, -1}, {-1, 0}, {-1, 1}, {0, -1}, {0, 1}, {1, -1}, {1, 0}, {1, 1} };
+static constexpr int kWhitePawnOffsets[2][2] = { {-1, -1}, {-1, 1} };
+static constexpr int kBlackPawnOffsets[2][2] = { {1, -1}, {1, 1} };
+static constexpr int kRookDirections[4][2] = { {-1, 0}, {1, 0}, {0, -1}, {0, 1} };
+static constexpr int kBishopDirections[4][2] = { {-1, -1}, {-1, 1}, {1, -1}, {1, 1} };
+
+/**
+ * Collects the squares reached by stepping once from a square by each of the given offsets,
+ * skipping any step that would leave the board.
+ *
+ * @param square: The square the steps start from
+ * @param offsets: (row, column) offsets of each step
+ * @param count: The number of offsets
+ * @return: The squares that can be reached.
+ */
+static constexpr Bitboard StepAttacks(int square, const int (*offsets)[2], int count)
+{
+	Bitboard attacks = kEmptyBitboard;
+	for (int i = 0; i < count; i++)
+	{
+		int row = square / 8 + offsets[i][0];
+		int column = square % 8 + offsets[i][1];
+		if (row >= 0 && row < 8 && column >= 0 && column < 8)
+		{
+			attacks |= SquareBit(row * 8 + column);
+		}
+	}
+	return attacks;
+}
+
+/**
+ * Collects the squares a sliding piece can reach from a square along the given directions.
+ * Each ray stops at the first occupied square, which is included so that it can be captured.
+ *
+ * @param square: The square the piece is on
+ * @param occupied: Every occupied square on the board
+ * @param directions: (row, column) step of each ray
+ * @param count: The number of directions
+ * @return: The squares the piece attacks.
+ */
+static constexpr Bitboard SlidingAttacks(int square, Bitboard occupied, const int (*directions)[2], int count)
+{
+	Bitboard attacks = kEmptyBitboard;
+	for (int i = 0; i < count; i++)
+	{
+		int row = square / 8 + directions[i][0];
+		int column = square % 8 + directions[i][1];
+		while (row >= 0 && row < 8 && column >= 0 && column < 8)
+		{
+			attacks |= SquareBit(row * 8 + column);
+			if (occupied & SquareBit(row * 8 + column))
+			{
+				break;
+			}
+			row += directions[i][0];
+			column += directions[i][1];
+		}
+	}
+	return attacks;
+}
+
+/**
+ * @param offsets: (row, column) offsets of each step
+ * @param count: The number of offsets
+ * @return: The step attacks of every square.
+ */
+static constexpr array<Bitboard, 64> MakeStepTable(const int (*offsets)[2], int count)
+{
+	array<Bitboard, 64> table{};
+	for (int square = 0; square < 64; square++)
+	{
+		table[square] = StepAttacks(square, offsets, count);
+	}
+	return table;
+}
+
+/**
+ * @param directions: (row, column) step of each ray
+ * @return: The empty board sliding attacks of every square.
+ */
+static constexpr array<Bitboard, 64> MakeRayTable(const int (*directions)[2])
+{
+	array<Bitboard, 64> table{};
+	for (int square = 0; square < 64; square++)
+	{
+		table[square] = SlidingAttacks(square, kEmptyBitboard, directions, 4);
+	}
+	return table;
+}
+
+/**
+ * Builds the table of squares between every pair of squares. Two squares on a common line see each
+ * other when each is treated as the only blocker, and the squares both rays cover are the ones between them.
+ *
+ * @return: The between table.
+ */
+static constexpr array<array<Bitboard, 64>, 64> MakeBetweenTable()
+{
+	array<array<Bitboard, 64>, 64> table{};
+	for (int start = 0; start < 64; start++)
+	{
+		for (int end = 0; end < 64; end++)
+		{
+			if (SlidingAttacks(start, kEmptyBitboard, kRookDirections, 4) & SquareBit(end))
+			{
+				table[start][end] = SlidingAttacks(start, SquareBit(end), kRookDirections, 4)
+					& SlidingAttacks(end, SquareBit(start), kRookDirections, 4);
+			}
+			else if (SlidingAttacks(start, kEmptyBitboard, kBishopDirections, 4) & SquareBit(end))
+			{
+				table[start][end] = SlidingAttacks(start, SquareBit(end), kBishopDirections, 4)
+					& SlidingAttacks(end, SquareBit(start), kBishopDirections, 4);
+			}
+		}
+	}
+	return table;
+}
+
+/**
+ * Builds the table of full lines through every pair of squares. The rays from both squares overlap on
+ * the rest of their common line, and the two squares themselves are added back.
+ *
+ * @return: The line table.
+ */
+static constexpr array<array<Bitboard, 64>, 64> MakeLineTable()
+{
+	array<array<Bitboard, 64>, 64> table{};
+	for (int start = 0; start < 64; start++)
+	{
+		for (int end = 0; end < 64; end++)
+		{
+			Bitboard ends = SquareBit(start) | SquareBit(end);
+			for (const int (*directions)[2] : { kRookDirections, kBishopDirections })
+			{
+				Bitboard start_rays = SlidingAttacks(start, kEmptyBitboard, directions, 4);
+				if (start_rays & SquareBit(end))
+				{
+					table[start][end] = (start_rays & SlidingAttacks(end, kEmptyBitboard, directions, 4)) | ends;
+				}
+			}
+		}
+	}
+	return table;
+}
+
+/**
+ * @return: The number of king steps between every pair of squares.
+ */
+static constexpr array<array<uint8_t, 64>, 64> MakeDistanceTable()
+{
+	array<array<uint8_t, 64>, 64> table{};
+	for (int start = 0; start < 64; start++)
+	{
+		for (int end = 0; end < 64; end++)
+		{
+			int rows = start / 8 > end / 8 ? start / 8 - end / 8 : end / 8 - start / 8;
+			int columns = start % 8 > end % 8 ? start % 8 - end % 8 : end % 8 - start % 8;
+			table[start][end] = static_cast<uint8_t>(rows > columns ? rows : columns);
+		}
+	}
+	return table;
+}
+
+constexpr array<Bitboard, 64> kKnightAttacks = MakeStepTable(kKnightOffsets, 8);
+constexpr array<Bitboard, 64> kKingAttacks = MakeStepTable(kKingOffsets, 8);
+constexpr array<array<Bitboard, 64>, 2> kPawnAttacks = { MakeStepTable(kWhitePawnOffsets, 2), MakeStepTable(kBlackPawnOffsets, 2) };
+constexpr array<Bitboard, 64> kRookRays = MakeRayTable(kRookDirections);
+constexpr array<Bitboard, 64> kBishopRays = MakeRayTable(kBishopDirections);
+constexpr array<array<Bitboard, 64>, 64> kBetween = MakeBetweenTable();
+constexpr array<array<Bitboard, 64>, 64> kLine = MakeLineTable();
+constexpr array<array<uint8_t, 64>, 64> kSquareDistance = MakeDistanceTable();
+
+/**
+ * Walks the four straight rays from a square. This is the slow reference version, used to fill in
+ * the lookup tables behind RookAttacks.
+ *
+ * @param square: The square the rook is on
+ * @param occupied: Every occupied square on the board
+ * @return: The squares a rook on that square attacks.
+ */
+Bitboard RookRayAttacks(int square, Bitboard occupied)
+{
+	return SlidingAttacks(square, occupied, kRookDirections, 4);
+}
+
+/**
+ * Walks the four diagonal rays from a square. This is the slow reference version, used to fill in
+ * the lookup tables behind BishopAttacks.
+ *
+ * @param square: The square the bishop is on
+ * @param occupied: Every occupied square on the board
+ * @return: The squares a bishop on that square attacks.
+ */
+Bitboard BishopRayAttacks(int square, Bitboard occupied)
+{
+	return SlidingAttacks(square, occupied, kBishopDirections, 4);
+}
@@ -0,0 +1,132 @@
+#pragma once
+#include "ChessPiece.h"
+
+#include <array>
+using std::array;
+#include <cstdint>
+#include <utility>
+using std::pair;
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+/**
+ * A set of squares stored as one bit per square. Squares are numbered row * 8 + column
+ * using the same (row, column) coordinates as the rest of the board, so square 0 is the
+ * top left corner of the printed board (black's queen side rook) and square 63 is the bottom right.
+ */
+typedef uint64_t Bitboard;
+
+const Bitboard kEmptyBitboard = 0;
+// Used wherever a square number is optional, such as when there is no en passant square.
+const int kNoSquare = -1;
+
+/**
+ * Converts a (row, column) pair into a square number.
+ *
+ * @param position: The row and column of the square
+ * @return: The square number, from 0 to 63.
+ */
+constexpr int SquareOf(pair<int, int> position)
+{
+	return position.first * 8 + position.second;
+}
+
+/**
+ * Converts a square number back into a (row, column) pair.
+ *
+ * @param square: The square number, from 0 to 63.
+ * @return: The row and column of the square.
+ */
+constexpr pair<int, int> PositionOf(int square)
+{
+	return pair<int, int>(square / 8, square % 8);
+}
+
+/**
+ * @param square: The square number, from 0 to 63.
+ * @return: A bitboard with only that square set.
+ */
+constexpr Bitboard SquareBit(int square)
+{
+	return Bitboard(1) << square;
+}
+
+/**
+ * @return: The number of squares set in the bitboard.
+ */
+inline int PopCount(Bitboard bitboard)
+{
+#ifdef _MSC_VER
+	return static_cast<int>(__popcnt64(bitboard));
+#else
+	return __builtin_popcountll(bitboard);
+#endif
+}
+
+/**
+ * Finds the lowest numbered square in a bitboard. The bitboard must not be empty.
+ *
+ * @return: The lowest square set in the bitboard.
+ */
+inline int LowestSquare(Bitboard bitboard)
+{
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward64(&index, bitboard);
+	return static_cast<int>(index);
+#else
+	return __builtin_ctzll(bitboard);
+#endif
+}
+
+/**
+ * Removes the lowest numbered square from a bitboard and returns it. This is used to
+ * walk over every square in a set: while (set) { int square = PopLowestSquare(set); ... }
+ *
+ * @param bitboard: The bitboard to take the square from. Must not be empty.
+ * @return: The square that was removed.
+ */
+inline int PopLowestSquare(Bitboard& bitboard)
+{
+	int square = LowestSquare(bitboard);
+	bitboard &= bitboard - 1;
+	return square;
+}
+
+/**
+ * Tables of attacks and square geometry. They are all computed by the compiler, so looking one up
+ * costs a single load and there is nothing to set up when the program starts.
+ */
+extern const array<Bitboard, 64> kKnightAttacks;
+extern const array<Bitboard, 64> kKingAttacks;
+// Indexed by ColorIndex, then square.
+extern const array<array<Bitboard, 64>, 2> kPawnAttacks;
+// The squares a rook or bishop attacks from each square on an empty board.
+extern const array<Bitboard, 64> kRookRays;
+extern const array<Bitboard, 64> kBishopRays;
+// The squares strictly between two squares on a common line, or empty.
+extern const array<array<Bitboard, 64>, 64> kBetween;
+// The whole line through two squares, edge to edge, or empty.
+extern const array<array<Bitboard, 64>, 64> kLine;
+// The number of king steps between two squares.
+extern const array<array<uint8_t, 64>, 64> kSquareDistance;
+
+inline Bitboard BetweenSquares(int start, int end) { return kBetween[start][end]; }
+
+// A piece pinned against its king may only move along this line.
+inline Bitboard LineThrough(int start, int end) { return kLine[start][end]; }
+
+inline int SquareDistance(int start, int end) { return kSquareDistance[start][end]; }
+
+inline Bitboard KnightAttacks(int square) { return kKnightAttacks[square]; }
+
+inline Bitboard KingAttacks(int square) { return kKingAttacks[square]; }
+
+// White pawns move towards row 0 and black pawns towards row 7.
+inline Bitboard PawnAttacks(Color color, int square) { return kPawnAttacks[ColorIndex(color)][square]; }
+
+Bitboard RookRayAttacks(int square, Bitboard occupied);
+
+Bitboard BishopRayAttacks(int square, Bitboard occupied);
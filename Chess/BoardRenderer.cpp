@@ -0,0 +1,227 @@
+#include "BoardRenderer.h"
+
+#include <cstdio>
+#ifdef _WIN32
+#include <io.h>
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+// The terminal line and column (both counted from 1) of the first square, and the steps between squares.
+// The column numbers take the first line and every row of squares is followed by a separator line.
+const int kFirstSquareLine = 3;
+const int kFirstSquareColumn = 3;
+const int kSquareLineStep = 2;
+const int kSquareColumnStep = 3;
+// The first terminal line below the board, where the scrolling part of the screen starts in Diff mode.
+const int kFirstTextLine = kFirstSquareLine + 8 * kSquareLineStep;
+
+const char kColumnNumbers[] = "   0  1  2  3  4  5  6  7\n";
+const char kRowSeparator[] = " +--+--+--+--+--+--+--+--+ \n";
+
+/**
+ * Writes the two letter name used for a square on the printed board, such as "WK", or "--" when it is empty.
+ *
+ * @param chess_piece: The piece on the square
+ * @param out: Where the two characters are written
+ * @return: None
+ */
+static void PieceText(ChessPiece chess_piece, char* out)
+{
+	static const char kPieceLetters[] = "-PNBRQK";
+	switch (chess_piece.GetColor())
+	{
+	case Color::White:
+		out[0] = 'W';
+		break;
+	case Color::Black:
+		out[0] = 'B';
+		break;
+	case Color::Empty:
+		out[0] = '-';
+		out[1] = '-';
+		return;
+	}
+	out[1] = kPieceLetters[static_cast<int>(chess_piece.GetPiece())];
+}
+
+/**
+ * @param mode: How boards are drawn. Diff mode takes over the top of the terminal on the first Draw.
+ */
+BoardRenderer::BoardRenderer(RenderMode mode)
+	: mode_(mode)
+{
+	frame_.reserve(1024);
+#ifdef _WIN32
+	if (mode_ == RenderMode::Diff)
+	{
+		// Windows consoles only follow ANSI escape sequences once they have been asked to.
+		HANDLE console = GetStdHandle(STD_OUTPUT_HANDLE);
+		DWORD console_mode = 0;
+		if (GetConsoleMode(console, &console_mode))
+		{
+			SetConsoleMode(console, console_mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+		}
+	}
+#endif
+}
+
+/**
+ * Gives the whole terminal back to scrolling text if Diff mode had reserved the top of it.
+ */
+BoardRenderer::~BoardRenderer()
+{
+	if (mode_ == RenderMode::Diff && has_drawn_)
+	{
+		// Resetting the scrolling region moves the cursor to the top, so move it back to the bottom line.
+		frame_.assign("\x1b[r\x1b[999;1H");
+		WriteFrame();
+	}
+}
+
+/**
+ * Adds the whole board to the frame in the same layout PrintBoard has always used.
+ *
+ * @param chess_board: The board to draw
+ * @return: None
+ */
+void BoardRenderer::AppendBoard(const ChessBoard& chess_board)
+{
+	const auto& board = chess_board.GetBoard();
+	frame_.append(kColumnNumbers);
+	for (int row = 0; row < 8; row++)
+	{
+		frame_.append(kRowSeparator);
+		frame_.push_back(static_cast<char>('0' + row));
+		frame_.push_back('|');
+		for (int column = 0; column < 8; column++)
+		{
+			char text[2];
+			PieceText(board[row][column], text);
+			frame_.append(text, 2);
+			frame_.push_back('|');
+		}
+		frame_.push_back('\n');
+	}
+	frame_.append(kRowSeparator);
+}
+
+/**
+ * Adds a cursor movement and the new contents for every square that differs from what is on the screen.
+ * The cursor is saved first and restored afterwards, so text below the board carries on where it was.
+ *
+ * @param chess_board: The board to draw
+ * @return: None
+ */
+void BoardRenderer::AppendChanges(const ChessBoard& chess_board)
+{
+	const auto& board = chess_board.GetBoard();
+	bool any_changed = false;
+	for (int square = 0; square < 64; square++)
+	{
+		ChessPiece chess_piece = board[square / 8][square % 8];
+		if (chess_piece.GetColor() == drawn_[square].GetColor() && chess_piece.GetPiece() == drawn_[square].GetPiece())
+		{
+			continue;
+		}
+		if (!any_changed)
+		{
+			frame_.append("\x1b" "7");
+			any_changed = true;
+		}
+		char text[24];
+		int length = std::snprintf(text, sizeof(text), "\x1b[%d;%dH",
+			kFirstSquareLine + (square / 8) * kSquareLineStep, kFirstSquareColumn + (square % 8) * kSquareColumnStep);
+		frame_.append(text, length);
+		PieceText(chess_piece, text);
+		frame_.append(text, 2);
+		drawn_[square] = chess_piece;
+	}
+	if (any_changed)
+	{
+		frame_.append("\x1b" "8");
+	}
+}
+
+/**
+ * Sends the frame to standard output with one write and empties it. Anything already waiting in the
+ * standard output buffer, such as a prompt, is flushed first so that the output stays in order.
+ *
+ * @return: None
+ */
+void BoardRenderer::WriteFrame()
+{
+	std::fflush(stdout);
+	const char* data = frame_.data();
+	size_t remaining = frame_.size();
+	while (remaining > 0)
+	{
+#ifdef _WIN32
+		int written = _write(1, data, static_cast<unsigned int>(remaining));
+#else
+		ssize_t written = write(STDOUT_FILENO, data, remaining);
+#endif
+		if (written <= 0)
+		{
+			break;
+		}
+		data += written;
+		remaining -= static_cast<size_t>(written);
+	}
+	frame_.clear();
+}
+
+/**
+ * Shows the board. In Diff mode the first call clears the terminal, draws the board at the top and keeps
+ * the lines below it for scrolling text; later calls only send the squares that changed.
+ *
+ * @param chess_board: The board to draw
+ * @return: None
+ */
+void BoardRenderer::Draw(const ChessBoard& chess_board)
+{
+	switch (mode_)
+	{
+	case RenderMode::Quiet:
+		return;
+	case RenderMode::Full:
+		AppendBoard(chess_board);
+		break;
+	case RenderMode::Diff:
+		if (has_drawn_)
+		{
+			AppendChanges(chess_board);
+			break;
+		}
+		frame_.append("\x1b[2J\x1b[H");
+		AppendBoard(chess_board);
+		for (int square = 0; square < 64; square++)
+		{
+			drawn_[square] = chess_board.GetBoard()[square / 8][square % 8];
+		}
+		char text[24];
+		int length = std::snprintf(text, sizeof(text), "\x1b[%dr\x1b[%d;1H", kFirstTextLine, kFirstTextLine);
+		frame_.append(text, length);
+		has_drawn_ = true;
+		break;
+	}
+	WriteFrame();
+}
+
+/**
+ * Prints one line of news about the game, such as a check. Nothing is printed in Quiet mode.
+ *
+ * @param text: The line to print, without a line break
+ * @return: None
+ */
+void BoardRenderer::Message(const char* text)
+{
+	if (mode_ == RenderMode::Quiet)
+	{
+		return;
+	}
+	frame_.append(text);
+	frame_.push_back('\n');
+	WriteFrame();
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include "ChessBoard.h"
+
+#include <array>
+using std::array;
+#include <string>
+using std::string;
+
+/**
+ * How a BoardRenderer shows the board.
+ * Full redraws the whole board below whatever was printed before, as the game always has.
+ * Diff draws the board once at the top of the terminal and afterwards only rewrites the squares that
+ * changed, using ANSI cursor movement. Everything else printed scrolls underneath it.
+ * Quiet prints nothing at all, for scripted games and for timing the rules without the terminal.
+ */
+enum class RenderMode { Full, Diff, Quiet };
+
+/**
+ * Draws boards and game messages for the terminal. Each frame is built in a buffer that is kept between
+ * frames and written with a single system call, rather than flushing the stream once per row.
+ * The rules code never prints; anything the player should be told goes through here.
+ */
+class BoardRenderer
+{
+private:
+	RenderMode mode_;
+	string frame_;
+	// What is on the screen in Diff mode, so that the next frame only sends the squares that differ.
+	array<ChessPiece, 64> drawn_;
+	bool has_drawn_ = false;
+
+	void AppendBoard(const ChessBoard& chess_board);
+	void AppendChanges(const ChessBoard& chess_board);
+	void WriteFrame();
+
+public:
+	explicit BoardRenderer(RenderMode mode = RenderMode::Full);
+	BoardRenderer(const BoardRenderer&) = delete;
+	BoardRenderer& operator=(const BoardRenderer&) = delete;
+	~BoardRenderer();
+
+	RenderMode GetMode() const { return mode_; }
+
+	void Draw(const ChessBoard& chess_board);
+	void Message(const char* text);
+};
@@ -0,0 +1,157 @@
+#include "GameArchive.h"
+#include "MappedFile.h"
+#include "OpeningBook.h"
+#include "Pgn.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include <string>
+using std::string;
+
+// How many moves of each game go into a book when no number is given.
+const int kDefaultBookPlies = 20;
+
+/**
+ * Builds a book from every game of a PGN file, or of a binary archive if the name ends in ".bin".
+ *
+ * @param games_path: The games to read
+ * @param book_path: The book file to write
+ * @param max_plies: How many moves of each game to add
+ * @return: True if the book was written, false otherwise.
+ */
+static bool BuildBook(const string& games_path, const string& book_path, int max_plies)
+{
+	OpeningBookWriter writer;
+	uint64_t games = 0;
+	uint64_t games_added = 0;
+	PgnGame game;
+	if (games_path.size() > 4 && games_path.compare(games_path.size() - 4, 4, ".bin") == 0)
+	{
+		GameArchive archive;
+		if (!archive.Open(games_path))
+		{
+			cout << "Could not open the archive " << games_path << endl;
+			return false;
+		}
+		for (uint64_t number = 0; number < archive.GetGameCount(); number++)
+		{
+			games++;
+			if (archive.ToPgn(number, game) && writer.AddGame(game, max_plies))
+			{
+				games_added++;
+			}
+		}
+	}
+	else
+	{
+		MappedFile file;
+		if (!file.Open(games_path))
+		{
+			cout << "Could not open " << games_path << endl;
+			return false;
+		}
+		PgnReader reader(file.begin(), file.end());
+		while (reader.ReadGame(game))
+		{
+			games++;
+			if (game.error.empty() && writer.AddGame(game, max_plies))
+			{
+				games_added++;
+			}
+		}
+	}
+	if (!writer.Write(book_path))
+	{
+		cout << "Could not write " << book_path << endl;
+		return false;
+	}
+	cout << "Added " << games_added << " of " << games << " games, " << writer.GetEntryCount() << " moves before merging" << endl;
+	return true;
+}
+
+/**
+ * Lists the book moves of a position and times random probes of the book.
+ *
+ * @param book_path: The book to read
+ * @param fen: The position, or empty for the start position
+ * @return: True if the book could be opened, false otherwise.
+ */
+static bool ShowBook(const string& book_path, const string& fen)
+{
+	auto open_start = std::chrono::steady_clock::now();
+	OpeningBook book;
+	if (!book.Open(book_path))
+	{
+		cout << "Could not open the book " << book_path << endl;
+		return false;
+	}
+	double open_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - open_start).count();
+	cout << book.GetEntryCount() << " entries, opened in " << open_seconds * 1e6 << " microseconds\n";
+
+	ChessBoard chess_board;
+	chess_board.Reset();
+	if (!fen.empty() && !chess_board.FromFEN(fen.c_str()))
+	{
+		cout << "Could not read the position " << fen << endl;
+		return false;
+	}
+	BookMove moves[kMaxBookMoves];
+	int count = book.Probe(chess_board, moves, kMaxBookMoves);
+	for (int i = 0; i < count; i++)
+	{
+		cout << moves[i].move << " " << moves[i].weight << '\n';
+	}
+	if (count == 0)
+	{
+		cout << "The position is not in the book\n";
+	}
+
+	// Follow random book lines from the start, so that the probes land all over the file.
+	const int kProbes = 100000;
+	std::mt19937_64 random(1);
+	auto probe_start = std::chrono::steady_clock::now();
+	chess_board.Reset();
+	int found = 0;
+	for (int i = 0; i < kProbes; i++)
+	{
+		Move move = book.PickMove(chess_board, random());
+		if (move == Move() || chess_board.GetHistory().size() >= static_cast<size_t>(kDefaultBookPlies))
+		{
+			chess_board.Reset();
+			continue;
+		}
+		found++;
+		chess_board.MakeMove(move);
+	}
+	double probe_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - probe_start).count();
+	cout << kProbes << " probes (" << found << " in the book) in " << probe_seconds << " s, "
+		<< probe_seconds * 1e6 / kProbes << " microseconds each" << endl;
+	return true;
+}
+
+/**
+ * Builds and reads Polyglot opening books.
+ *
+ * Usage:
+ *   book build <games file> <book file> [plies]   Build a book from the first moves of every game with a result.
+ *   book <book file> [fen]                        List the book moves of a position and time probes of the book.
+ *
+ * @return: 0 on success, 1 otherwise.
+ */
+int main(int argc, char* argv[])
+{
+	if (argc >= 4 && string(argv[1]) == "build")
+	{
+		int max_plies = argc >= 5 ? std::atoi(argv[4]) : kDefaultBookPlies;
+		return BuildBook(argv[2], argv[3], max_plies) ? 0 : 1;
+	}
+	if (argc >= 2 && string(argv[1]) != "build")
+	{
+		return ShowBook(argv[1], argc >= 3 ? argv[2] : "") ? 0 : 1;
+	}
+	cout << "Usage: book build <games file> <book file> [plies]\n"
+		"       book <book file> [fen]" << endl;
+	return 1;
+}
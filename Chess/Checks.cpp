@@ -0,0 +1,251 @@
+#include "ChessBoard.h"
+#include "ChessGame.h"
+#include "MoveGen.h"
+#include "MovePicker.h"
+#include "OpeningBook.h"
+#include "Pgn.h"
+
+#include <cstdint>
+
+#include <string>
+using std::string;
+#include <vector>
+using std::vector;
+
+/**
+ * A position FromFEN must refuse, and why.
+ */
+struct RefusedPosition
+{
+	string name;
+	string fen;
+};
+
+static const vector<RefusedPosition> kRefusedPositions = {
+	{ "White pawn on the last rank", "P3k3/8/8/8/8/8/8/4K3 w - - 0 1" },
+	{ "Black pawn on the first rank", "4k3/8/8/8/8/8/8/p3K3 b - - 0 1" },
+	{ "No white king", "4k3/8/8/8/8/8/8/8 w - - 0 1" },
+	{ "No black king", "8/8/8/8/8/8/8/4K3 w - - 0 1" },
+	{ "Two white kings", "4k3/8/8/8/8/8/8/3KK3 w - - 0 1" },
+	{ "Two black kings", "3kk3/8/8/8/8/8/8/4K3 b - - 0 1" },
+	{ "Side not to move in check", "4k3/8/8/8/8/8/8/3KR3 w - - 0 1" },
+	{ "En passant square on the wrong rank", "4k3/8/8/3pP3/8/8/8/4K3 w - d4 0 1" },
+	{ "En passant square for the wrong side", "4k3/8/8/8/3pP3/8/8/4K3 w - e3 0 1" },
+	{ "En passant square with no pawn in front", "4k3/8/8/4P3/8/8/8/4K3 w - d6 0 1" },
+	{ "Castling right with no king", "4k3/8/8/8/8/8/8/R2K3R w K - 0 1" },
+	{ "Castling right with no rook", "4k3/8/8/8/8/8/8/4K3 w Q - 0 1" },
+	{ "Castling right with the other side's rook", "4k3/8/8/8/8/8/8/r3K3 b Q - 0 1" },
+};
+
+/**
+ * A position and its Polyglot key, from the examples given with the Polyglot format.
+ */
+struct PolyglotExample
+{
+	string name;
+	string fen;
+	uint64_t key;
+};
+
+static const vector<PolyglotExample> kPolyglotExamples = {
+	{ "start position", "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 0x463B96181691FC9CULL },
+	{ "after e4", "rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 1", 0x823C9B50FD114196ULL },
+	{ "after e4 d5", "rnbqkbnr/ppp1pppp/8/3p4/4P3/8/PPPP1PPP/RNBQKBNR w KQkq d6 0 2", 0x0756B94461C50FB0ULL },
+	{ "after e4 d5 e5", "rnbqkbnr/ppp1pppp/8/3pP3/8/8/PPPP1PPP/RNBQKBNR b KQkq - 0 2", 0x662FAFB965DB29D4ULL },
+	{ "after e4 d5 e5 f5", "rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3", 0x22A48B5A8E47FF78ULL },
+	{ "after e4 d5 e5 f5 Ke2", "rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPPKPPP/RNBQ1BNR b kq - 0 3", 0x652A607CA3F242C1ULL },
+	{ "after e4 d5 e5 f5 Ke2 Kf7", "rnbq1bnr/ppp1pkpp/8/3pPp2/8/8/PPPPKPPP/RNBQ1BNR w - - 0 4", 0x00FDD303C946BDD9ULL },
+	{ "after a4 b5 h4 b4 c4", "rnbqkbnr/p1pppppp/8/8/PpP4P/8/1P1PPPP1/RNBQKBNR b KQkq c3 0 3", 0x3C8123EA7B067637ULL },
+	{ "after a4 b5 h4 b4 c4 bxc3 Ra3", "rnbqkbnr/p1pppppp/8/8/P6P/R1p5/1P1PPPP1/1NBQKBNR b Kkq - 0 4", 0x5C3F9B829B279560ULL },
+};
+
+/**
+ * Prints the outcome of one check.
+ *
+ * @param passed: Whether the check passed
+ * @param name: What was checked
+ * @return: The passed argument, so results can be combined.
+ */
+static bool Report(bool passed, const string& name)
+{
+	cout << (passed ? "[ OK ] " : "[FAIL] ") << name << '\n';
+	return passed;
+}
+
+/**
+ * Checks that FromFEN refuses positions the move generator cannot handle, leaving the board as it was,
+ * and still reads a position that only just avoids each of them.
+ *
+ * @return: True if every check passed, false otherwise.
+ */
+static bool CheckFEN()
+{
+	bool all_passed = true;
+	ChessBoard start_board;
+	start_board.Reset();
+	ChessBoard chess_board;
+	chess_board.Reset();
+	for (const RefusedPosition& position : kRefusedPositions)
+	{
+		bool refused = !chess_board.FromFEN(position.fen.c_str());
+		all_passed = Report(refused && chess_board.GetHash() == start_board.GetHash(), "FEN refused: " + position.name) && all_passed;
+	}
+
+	// Just inside every rule: both castling rights on each side, and an en passant capture.
+	bool read = chess_board.FromFEN("r3k2r/8/8/3pP3/8/8/8/R3K2R w KQkq d6 0 1");
+	int castling_moves = 0;
+	int en_passant_moves = 0;
+	MoveList move_list;
+	GenerateLegalMoves(chess_board, move_list);
+	for (Move move : move_list)
+	{
+		castling_moves += move.GetType() == MoveType::Castling;
+		en_passant_moves += move.GetType() == MoveType::EnPassant;
+	}
+	all_passed = Report(read && castling_moves == 2 && en_passant_moves == 1, "FEN read: castling rights and en passant") && all_passed;
+	return all_passed;
+}
+
+/**
+ * Checks that the PGN reader takes castling written with zeros as well as with letters, including when a
+ * move number runs straight into it.
+ *
+ * @return: True if every check passed, false otherwise.
+ */
+static bool CheckPgn()
+{
+	const string text =
+		"[Event \"Castling\"]\n\n1. e4 e5 2. Nf3 Nc6 3. Bc4 Bc5 4. 0-0 d6 5. d3 Bg4 6. h3 Qd7 7. hxg4 O-O-O 8.O-O-O *\n\n"
+		"[Event \"Castling\"]\n\n1. d4 d5 2. Nc3 Nc6 3. Bf4 Bf5 4. Qd2 Qd7 5. 0-0-0 0-0-0 1/2-1/2\n";
+	PgnReader reader(text.data(), text.data() + text.size());
+	PgnGame game;
+	bool all_passed = true;
+
+	bool read = reader.ReadGame(game) && game.moves.size() == 14;
+	all_passed = Report(read && game.moves[6].GetType() == MoveType::Castling && game.moves[13].GetType() == MoveType::Castling,
+		"PGN read: 0-0 and O-O-O") && all_passed;
+	// "8.O-O-O" after white has castled short is not legal, and is the only move refused.
+	all_passed = Report(game.error == "illegal or ambiguous move O-O-O after 14 plies", "PGN refused: castling a second time") && all_passed;
+
+	read = reader.ReadGame(game) && game.error.empty() && game.moves.size() == 10 && game.result == "1/2-1/2";
+	all_passed = Report(read && game.moves[8].GetType() == MoveType::Castling && game.moves[9].GetType() == MoveType::Castling,
+		"PGN read: 0-0-0 for both sides") && all_passed;
+	return all_passed;
+}
+
+/**
+ * Checks that positions hash to the same keys as in Polyglot, so that books from other programs are read.
+ *
+ * @return: True if every check passed, false otherwise.
+ */
+static bool CheckPolyglot()
+{
+	bool all_passed = true;
+	ChessBoard chess_board;
+	for (const PolyglotExample& example : kPolyglotExamples)
+	{
+		bool read = chess_board.FromFEN(example.fen.c_str());
+		all_passed = Report(read && PolyglotKey(chess_board) == example.key, "Polyglot key: " + example.name) && all_passed;
+	}
+
+	// The key must not depend on how the position was reached.
+	chess_board.Reset();
+	for (const char* move : { "e2e4", "d7d5", "e4e5", "f7f5" })
+	{
+		chess_board.MakeMove(ParseMove(chess_board, move));
+	}
+	all_passed = Report(PolyglotKey(chess_board) == 0x22A48B5A8E47FF78ULL, "Polyglot key: after playing e4 d5 e5 f5") && all_passed;
+	return all_passed;
+}
+
+/**
+ * A capture, and what StaticExchange must say it wins.
+ */
+struct ExchangeExample
+{
+	string name;
+	string fen;
+	string move;
+	int gain;
+};
+
+static const vector<ExchangeExample> kExchangeExamples = {
+	{ "undefended capture-promotion", "r3k3/1P6/8/8/8/8/8/4K3 w - - 0 1", "b7a8q", 1300 },
+	// The knight takes the new queen back and white's rook takes the knight: rook, queen and knight for a queen.
+	{ "defended capture-promotion", "r3k3/1P6/1n6/8/8/8/8/R3K3 w - - 0 1", "b7a8q", 720 },
+	// Without the rook, the queen is lost for the rook.
+	{ "defended capture-promotion, not supported", "r3k3/1P6/1n6/8/8/8/8/4K3 w - - 0 1", "b7a8q", 400 },
+	{ "defended capture-underpromotion", "r3k3/1P6/1n6/8/8/8/8/R3K3 w - - 0 1", "b7a8n", 720 },
+	// The pawn that would take the knight back queens, so black does better not to take the queen.
+	{ "pawn recapturing onto the last rank", "1r2k3/P2n4/8/8/8/8/8/1Q2K3 w - - 0 1", "b1b8", 500 },
+};
+
+/**
+ * Checks the static exchange evaluation of captures that promote.
+ *
+ * @return: True if every check passed, false otherwise.
+ */
+static bool CheckStaticExchange()
+{
+	bool all_passed = true;
+	ChessBoard chess_board;
+	for (const ExchangeExample& example : kExchangeExamples)
+	{
+		bool read = chess_board.FromFEN(example.fen.c_str());
+		Move move = read ? ParseMove(chess_board, example.move.c_str()) : Move();
+		int gain = move != Move() ? StaticExchange(chess_board, move) : 0;
+		all_passed = Report(move != Move() && gain == example.gain,
+			"Static exchange: " + example.name + " (" + std::to_string(gain) + ")") && all_passed;
+	}
+	return all_passed;
+}
+
+/**
+ * Checks that helper threads started after a search wait for the next one, rather than running the finished
+ * search again while the board changes. A race here shows up under a thread sanitizer (-fsanitize=thread).
+ *
+ * @return: True if every check passed, false otherwise.
+ */
+static bool CheckThreads()
+{
+	ChessGame game;
+	game.SetHashSize(1);
+	SearchLimits limits;
+	limits.max_depth = 4;
+	SearchResult first = game.FindBestMove(limits);
+	game.SetThreads(4);
+	ChessBoard& chess_board = game.GetBoard();
+	chess_board.Reset();
+	chess_board.MakeMove(ParseMove(chess_board, "e2e4"));
+	SearchResult second = game.FindBestMove(limits);
+	// The move must be one of black's, from the position searched the second time.
+	MoveList move_list;
+	GenerateLegalMoves(chess_board, move_list);
+	bool legal = false;
+	for (Move move : move_list)
+	{
+		legal = legal || move == second.best_move;
+	}
+	return Report(first.best_move != Move() && legal && second.depth == limits.max_depth,
+		"Threads: search, SetThreads(4), search again");
+}
+
+/**
+ * Checks the parts of the program that perft does not: reading and writing positions and games, book keys
+ * and restarting the search threads.
+ *
+ * Usage:
+ *   checks
+ *
+ * @return: 0 if every check passed, 1 otherwise.
+ */
+int main()
+{
+	bool all_passed = CheckFEN();
+	all_passed = CheckPgn() && all_passed;
+	all_passed = CheckPolyglot() && all_passed;
+	all_passed = CheckStaticExchange() && all_passed;
+	all_passed = CheckThreads() && all_passed;
+	cout << (all_passed ? "\nAll checks passed" : "\nSome checks failed") << endl;
+	return all_passed ? 0 : 1;
+}
@@ -1,26 +1,709 @@
 ﻿#include "ChessBoard.h"
+#include "BoardRenderer.h"
 #include "ChessPlayer.h"
+#include "Instrumentation.h"
+#include "MoveGen.h"
+#include "Tablebase.h"
+
+#include <cstdio>
+
+const array<array<ChessPiece, 8>, 8> ChessBoard::start_{ {{ChessPiece(Color::Black, Piece::Rook),
+	ChessPiece(Color::Black, Piece::Knight), ChessPiece(Color::Black, Piece::Bishop),
+	ChessPiece(Color::Black, Piece::Queen), ChessPiece(Color::Black, Piece::King),
+	ChessPiece(Color::Black, Piece::Bishop), ChessPiece(Color::Black, Piece::Knight), ChessPiece(Color::Black, Piece::Rook)},
+	{ChessPiece(Color::Black, Piece::Pawn), ChessPiece(Color::Black, Piece::Pawn), ChessPiece(Color::Black, Piece::Pawn),
+	ChessPiece(Color::Black, Piece::Pawn), ChessPiece(Color::Black, Piece::Pawn), ChessPiece(Color::Black, Piece::Pawn),
+	ChessPiece(Color::Black, Piece::Pawn), ChessPiece(Color::Black, Piece::Pawn)},
+	{ChessPiece(Color::Empty, Piece::Empty), ChessPiece(Color::Empty, Piece::Empty), ChessPiece(Color::Empty, Piece::Empty),
+	ChessPiece(Color::Empty, Piece::Empty), ChessPiece(Color::Empty, Piece::Empty), ChessPiece(Color::Empty, Piece::Empty),
+	ChessPiece(Color::Empty, Piece::Empty), ChessPiece(Color::Empty, Piece::Empty)},
+	{ChessPiece(Color::Empty, Piece::Empty), ChessPiece(Color::Empty, Piece::Empty), ChessPiece(Color::Empty, Piece::Empty),
+	ChessPiece(Color::Empty, Piece::Empty), ChessPiece(Color::Empty, Piece::Empty), ChessPiece(Color::Empty, Piece::Empty),
+	ChessPiece(Color::Empty, Piece::Empty), ChessPiece(Color::Empty, Piece::Empty)},
+	{ChessPiece(Color::Empty, Piece::Empty), ChessPiece(Color::Empty, Piece::Empty), ChessPiece(Color::Empty, Piece::Empty),
+	ChessPiece(Color::Empty, Piece::Empty), ChessPiece(Color::Empty, Piece::Empty), ChessPiece(Color::Empty, Piece::Empty),
+	ChessPiece(Color::Empty, Piece::Empty), ChessPiece(Color::Empty, Piece::Empty)},
+	{ChessPiece(Color::Empty, Piece::Empty), ChessPiece(Color::Empty, Piece::Empty), ChessPiece(Color::Empty, Piece::Empty),
+	ChessPiece(Color::Empty, Piece::Empty), ChessPiece(Color::Empty, Piece::Empty), ChessPiece(Color::Empty, Piece::Empty),
+	ChessPiece(Color::Empty, Piece::Empty), ChessPiece(Color::Empty, Piece::Empty)},
+	{ChessPiece(Color::White, Piece::Pawn), ChessPiece(Color::White, Piece::Pawn), ChessPiece(Color::White, Piece::Pawn),
+	ChessPiece(Color::White, Piece::Pawn), ChessPiece(Color::White, Piece::Pawn), ChessPiece(Color::White, Piece::Pawn),
+	ChessPiece(Color::White, Piece::Pawn), ChessPiece(Color::White, Piece::Pawn)},
+	{ChessPiece(Color::White, Piece::Rook),ChessPiece(Color::White, Piece::Knight), ChessPiece(Color::White, Piece::Bishop),
+	ChessPiece(Color::White, Piece::Queen), ChessPiece(Color::White, Piece::King), ChessPiece(Color::White, Piece::Bishop),
+	ChessPiece(Color::White, Piece::Knight), ChessPiece(Color::White, Piece::Rook)}} };
 
 /**
- * Prints the chess board
+ * Prints the chess board. The whole board is built in a buffer and written at once; see BoardRenderer
+ * for redrawing only the squares that changed.
  * 
  * @return None
  */
-void ChessBoard::PrintBoard()
+void ChessBoard::PrintBoard() const
 {
-	cout << "   0  1  2  3  4  5  6  7" << endl;
-	for (int i = 0; i < 8; i++)
+	BoardRenderer renderer;
+	renderer.Draw(*this);
+}
+
+/**
+ * Rebuilds every bitboard, the hash and the evaluation terms from the 8x8 board. This is used whenever the
+ * whole board is replaced.
+ *
+ * @return: None
+ */
+void ChessBoard::SyncBitboards()
+{
+	pieces_ = {};
+	occupancy_ = {};
+	hash_ = kEmptyBitboard;
+	piece_square_score_ = Score();
+	phase_ = 0;
+	if (network_ != nullptr)
+	{
+		network_->Clear(accumulator_.front());
+	}
+	for (int square = 0; square < 64; square++)
+	{
+		ChessPiece& chess_piece = board_[square / 8][square % 8];
+		if (chess_piece.GetColor() == Color::Empty || chess_piece.GetPiece() == Piece::Empty)
+		{
+			continue;
+		}
+		pieces_[static_cast<int>(chess_piece.GetPiece()) - 1] |= SquareBit(square);
+		occupancy_[ColorIndex(chess_piece.GetColor())] |= SquareBit(square);
+		AddPieceTerms(chess_piece, square);
+	}
+	if (side_to_move_ == Color::Black)
 	{
-		cout << " +--+--+--+--+--+--+--+--+ " << endl;
-		cout << i << '|';
-		for (int j = 0; j < 8; j++)
+		hash_ ^= SideKey();
+	}
+	if (en_passant_square_ != kNoSquare)
+	{
+		hash_ ^= EnPassantKey(en_passant_square_);
+	}
+
+	// The kings may be anywhere on a board that was set by hand.
+	for (Color color : { Color::White, Color::Black })
+	{
+		Bitboard king = GetPieces(color, Piece::King);
+		if (king)
 		{
-			ChessPiece& current_piece = GetBoard().at(i).at(j);
-			cout << current_piece << '|';
+			players_[color].SetKingPosition(PositionOf(LowestSquare(king)));
 		}
-		cout << endl;
 	}
-	cout << " +--+--+--+--+--+--+--+--+ " << endl;
+}
+
+/**
+ * Adds a piece's share of the hash and of the evaluation. Every term is a sum over the pieces, so a move only
+ * changes the terms of the pieces it moves, and taking it back subtracts exactly what it added.
+ *
+ * @param chess_piece: The piece placed, which must not be empty
+ * @param square: The square it is placed on
+ * @return: None
+ */
+void ChessBoard::AddPieceTerms(ChessPiece chess_piece, int square)
+{
+	hash_ ^= PieceKey(chess_piece.GetColor(), chess_piece.GetPiece(), square);
+	piece_square_score_ += PieceSquareScore(chess_piece.GetColor(), chess_piece.GetPiece(), square);
+	phase_ += kPhaseWeights[static_cast<int>(chess_piece.GetPiece())];
+	if (network_ != nullptr)
+	{
+		network_->AddPiece(accumulator_.front(), chess_piece.GetColor(), chess_piece.GetPiece(), square);
+	}
+}
+
+/**
+ * The reverse of AddPieceTerms.
+ *
+ * @param chess_piece: The piece removed, which must not be empty
+ * @param square: The square it is removed from
+ * @return: None
+ */
+void ChessBoard::RemovePieceTerms(ChessPiece chess_piece, int square)
+{
+	hash_ ^= PieceKey(chess_piece.GetColor(), chess_piece.GetPiece(), square);
+	piece_square_score_ -= PieceSquareScore(chess_piece.GetColor(), chess_piece.GetPiece(), square);
+	phase_ -= kPhaseWeights[static_cast<int>(chess_piece.GetPiece())];
+	if (network_ != nullptr)
+	{
+		network_->RemovePiece(accumulator_.front(), chess_piece.GetColor(), chess_piece.GetPiece(), square);
+	}
+}
+
+/**
+ * Puts a piece on a square, replacing whatever was there, and keeps the bitboards in step with the board.
+ *
+ * @param square: The square the piece is placed on
+ * @param chess_piece: The piece to place
+ * @return: None
+ */
+void ChessBoard::PlacePiece(int square, ChessPiece chess_piece)
+{
+	ClearSquare(square);
+	board_[square / 8][square % 8] = chess_piece;
+	if (chess_piece.GetColor() == Color::Empty || chess_piece.GetPiece() == Piece::Empty)
+	{
+		return;
+	}
+	pieces_[static_cast<int>(chess_piece.GetPiece()) - 1] |= SquareBit(square);
+	occupancy_[ColorIndex(chess_piece.GetColor())] |= SquareBit(square);
+	AddPieceTerms(chess_piece, square);
+}
+
+/**
+ * Removes whatever piece is on a square and keeps the bitboards in step with the board.
+ *
+ * @param square: The square to empty
+ * @return: None
+ */
+void ChessBoard::ClearSquare(int square)
+{
+	ChessPiece& chess_piece = board_[square / 8][square % 8];
+	if (chess_piece.GetColor() != Color::Empty && chess_piece.GetPiece() != Piece::Empty)
+	{
+		pieces_[static_cast<int>(chess_piece.GetPiece()) - 1] &= ~SquareBit(square);
+		occupancy_[ColorIndex(chess_piece.GetColor())] &= ~SquareBit(square);
+		RemovePieceTerms(chess_piece, square);
+	}
+	chess_piece = ChessPiece();
+}
+
+/**
+ * Sets whose turn it is and keeps the hash in step.
+ *
+ * @param color: The color of the player to move
+ * @return: None
+ */
+void ChessBoard::SetSideToMove(Color color)
+{
+	if (color != side_to_move_)
+	{
+		hash_ ^= SideKey();
+	}
+	side_to_move_ = color;
+}
+
+/**
+ * Sets the square a pawn skipped over on the last move and keeps the hash in step.
+ *
+ * @param square: The skipped square, or kNoSquare if the last move was not a two square pawn move
+ * @return: None
+ */
+void ChessBoard::SetEnPassantSquare(int square)
+{
+	if (en_passant_square_ != kNoSquare)
+	{
+		hash_ ^= EnPassantKey(en_passant_square_);
+	}
+	if (square != kNoSquare)
+	{
+		hash_ ^= EnPassantKey(square);
+	}
+	en_passant_square_ = square;
+}
+
+/**
+ * Reads a number from a FEN field and moves past it.
+ *
+ * @param text: The text to read from. Left pointing at the first character after the number.
+ * @param number: Set to the number read
+ * @return: True if there was a number, false otherwise.
+ */
+static bool ReadFENNumber(const char*& text, int& number)
+{
+	if (*text < '0' || *text > '9')
+	{
+		return false;
+	}
+	number = 0;
+	for (; *text >= '0' && *text <= '9'; text++)
+	{
+		number = number * 10 + (*text - '0');
+	}
+	return true;
+}
+
+/**
+ * Checks whether any piece of a color attacks a square of a board given as an array, before it is loaded.
+ *
+ * @param board: The pieces on each square
+ * @param square: The square being attacked
+ * @param attacker: The color of the attacking pieces
+ * @return: True if the square is attacked, false otherwise.
+ */
+static bool IsSquareAttacked(const array<array<ChessPiece, 8>, 8>& board, int square, Color attacker)
+{
+	Bitboard occupied = kEmptyBitboard;
+	for (int from = 0; from < 64; from++)
+	{
+		if (board[from / 8][from % 8].GetPiece() != Piece::Empty)
+		{
+			occupied |= SquareBit(from);
+		}
+	}
+	for (int from = 0; from < 64; from++)
+	{
+		const ChessPiece& chess_piece = board[from / 8][from % 8];
+		if (chess_piece.GetColor() != attacker)
+		{
+			continue;
+		}
+		Bitboard attacks = kEmptyBitboard;
+		switch (chess_piece.GetPiece())
+		{
+		case Piece::Pawn: attacks = PawnAttacks(attacker, from); break;
+		case Piece::Knight: attacks = KnightAttacks(from); break;
+		case Piece::Bishop: attacks = BishopAttacks(from, occupied); break;
+		case Piece::Rook: attacks = RookAttacks(from, occupied); break;
+		case Piece::Queen: attacks = QueenAttacks(from, occupied); break;
+		case Piece::King: attacks = KingAttacks(from); break;
+		default: break;
+		}
+		if (attacks & SquareBit(square))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * Sets up the board from a position in Forsyth-Edwards Notation. The board only tracks castling through
+ * whether pieces have moved, so every piece is marked as moved except pawns on their starting row and the
+ * king and rooks of each castling right. The halfmove clock and fullmove number may be left off.
+ * Nothing is allocated, so millions of positions can be loaded quickly.
+ *
+ * Positions the move generator cannot handle are refused: each side must have exactly one king, no pawn
+ * may stand on the first or last rank, the side that has just moved must not be in check, each castling
+ * right needs its king and rook on their starting squares, and an en passant square must be just behind
+ * a pawn that can have moved two squares.
+ *
+ * @param fen: The position, such as "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"
+ * @return: True if the position was read, false if the string is malformed or the position is refused. The board is unchanged on failure.
+ */
+bool ChessBoard::FromFEN(const char* fen)
+{
+	array<array<ChessPiece, 8>, 8> board{};
+	const char* text = fen;
+	int row = 0;
+	int column = 0;
+	array<int, 2> king_counts = {};
+	array<int, 2> king_squares = {};
+	for (; *text != ' '; text++)
+	{
+		char symbol = *text;
+		if (symbol == '\0')
+		{
+			return false;
+		}
+		if (symbol == '/')
+		{
+			if (column != 8 || ++row > 7)
+			{
+				return false;
+			}
+			column = 0;
+			continue;
+		}
+		if (symbol >= '1' && symbol <= '8')
+		{
+			column += symbol - '0';
+			if (column > 8)
+			{
+				return false;
+			}
+			continue;
+		}
+		if (column > 7)
+		{
+			return false;
+		}
+		Color color = symbol >= 'A' && symbol <= 'Z' ? Color::White : Color::Black;
+		Piece piece;
+		switch (color == Color::White ? symbol - 'A' + 'a' : symbol)
+		{
+		case 'p': piece = Piece::Pawn; break;
+		case 'n': piece = Piece::Knight; break;
+		case 'b': piece = Piece::Bishop; break;
+		case 'r': piece = Piece::Rook; break;
+		case 'q': piece = Piece::Queen; break;
+		case 'k': piece = Piece::King; break;
+		default: return false;
+		}
+		if (piece == Piece::Pawn && (row == 0 || row == 7))
+		{
+			return false;
+		}
+		if (piece == Piece::King)
+		{
+			king_counts[ColorIndex(color)]++;
+			king_squares[ColorIndex(color)] = row * 8 + column;
+		}
+		ChessPiece chess_piece(color, piece);
+		int start_row = color == Color::White ? 6 : 1;
+		chess_piece.SetHasMoved(piece != Piece::Pawn || row != start_row);
+		board[row][column++] = chess_piece;
+	}
+	if (row != 7 || column != 8 || king_counts[0] != 1 || king_counts[1] != 1)
+	{
+		return false;
+	}
+
+	text++;
+	if ((*text != 'w' && *text != 'b') || text[1] != ' ')
+	{
+		return false;
+	}
+	Color side_to_move = *text == 'w' ? Color::White : Color::Black;
+	text += 2;
+	// The side that has just moved cannot have left its king to be taken.
+	Color last_mover = GetOppositeColor(side_to_move);
+	if (IsSquareAttacked(board, king_squares[ColorIndex(last_mover)], side_to_move))
+	{
+		return false;
+	}
+
+	for (; *text != ' '; text++)
+	{
+		if (*text == '-')
+		{
+			continue;
+		}
+		if (*text != 'K' && *text != 'Q' && *text != 'k' && *text != 'q')
+		{
+			return false;
+		}
+		Color color = *text == 'K' || *text == 'Q' ? Color::White : Color::Black;
+		int back_row = color == Color::White ? 7 : 0;
+		ChessPiece& king = board[back_row][4];
+		ChessPiece& rook = board[back_row][*text == 'K' || *text == 'k' ? 7 : 0];
+		if (king.GetPiece() != Piece::King || king.GetColor() != color || rook.GetPiece() != Piece::Rook || rook.GetColor() != color)
+		{
+			return false;
+		}
+		king.SetHasMoved(false);
+		rook.SetHasMoved(false);
+	}
+	text++;
+
+	int en_passant_square = kNoSquare;
+	if (*text == '-')
+	{
+		text++;
+	}
+	else if (text[0] >= 'a' && text[0] <= 'h' && text[1] == (side_to_move == Color::White ? '6' : '3'))
+	{
+		// The pawn that has just moved two squares stands in front of the square, which it passed over
+		// from its starting square.
+		int en_passant_row = '8' - text[1];
+		int column_index = text[0] - 'a';
+		int pawn_row = side_to_move == Color::White ? en_passant_row + 1 : en_passant_row - 1;
+		int start_row = side_to_move == Color::White ? en_passant_row - 1 : en_passant_row + 1;
+		const ChessPiece& pawn = board[pawn_row][column_index];
+		if (pawn.GetPiece() != Piece::Pawn || pawn.GetColor() != last_mover
+			|| board[en_passant_row][column_index].GetPiece() != Piece::Empty || board[start_row][column_index].GetPiece() != Piece::Empty)
+		{
+			return false;
+		}
+		en_passant_square = en_passant_row * 8 + column_index;
+		text += 2;
+	}
+	else
+	{
+		return false;
+	}
+
+	int halfmove_clock = 0;
+	int fullmove_number = 1;
+	if (*text == ' ')
+	{
+		text++;
+		if (!ReadFENNumber(text, halfmove_clock) || *text++ != ' ' || !ReadFENNumber(text, fullmove_number))
+		{
+			return false;
+		}
+	}
+
+	board_ = board;
+	side_to_move_ = side_to_move;
+	en_passant_square_ = en_passant_square;
+	halfmove_clock_ = halfmove_clock;
+	fullmove_number_ = fullmove_number > 0 ? fullmove_number : 1;
+	history_.clear();
+	SyncBitboards();
+	for (Color color : { Color::White, Color::Black })
+	{
+		Bitboard king = GetPieces(color, Piece::King);
+		players_[color].SetCheck(king && IsSquareAttacked(*this, LowestSquare(king), GetOppositeColor(color)));
+	}
+	return true;
+}
+
+/**
+ * Writes the position in Forsyth-Edwards Notation. Nothing is allocated.
+ *
+ * @param buffer: Where to write the position. Must hold at least kMaxFENLength characters.
+ * @return: The length of the string written, not counting the terminating null character.
+ */
+int ChessBoard::ToFEN(char* buffer) const
+{
+	static const char kPieceSymbols[7] = { ' ', 'p', 'n', 'b', 'r', 'q', 'k' };
+	char* out = buffer;
+	for (int row = 0; row < 8; row++)
+	{
+		int empty = 0;
+		for (int column = 0; column < 8; column++)
+		{
+			const ChessPiece& chess_piece = board_[row][column];
+			if (chess_piece.GetPiece() == Piece::Empty)
+			{
+				empty++;
+				continue;
+			}
+			if (empty > 0)
+			{
+				*out++ = static_cast<char>('0' + empty);
+				empty = 0;
+			}
+			char symbol = kPieceSymbols[static_cast<int>(chess_piece.GetPiece())];
+			*out++ = chess_piece.GetColor() == Color::White ? static_cast<char>(symbol - 'a' + 'A') : symbol;
+		}
+		if (empty > 0)
+		{
+			*out++ = static_cast<char>('0' + empty);
+		}
+		*out++ = row < 7 ? '/' : ' ';
+	}
+
+	*out++ = side_to_move_ == Color::White ? 'w' : 'b';
+	*out++ = ' ';
+	int rights = GetCastlingRights();
+	if (rights == 0)
+	{
+		*out++ = '-';
+	}
+	// The rights are listed in the order of their bits: kWhiteKingSide, kWhiteQueenSide, kBlackKingSide, kBlackQueenSide.
+	for (int i = 0; i < 4; i++)
+	{
+		if (rights & (1 << i))
+		{
+			*out++ = "KQkq"[i];
+		}
+	}
+	*out++ = ' ';
+	if (en_passant_square_ == kNoSquare)
+	{
+		*out++ = '-';
+	}
+	else
+	{
+		*out++ = static_cast<char>('a' + en_passant_square_ % 8);
+		*out++ = static_cast<char>('8' - en_passant_square_ / 8);
+	}
+	// The two counters take at most eleven characters each, which kMaxFENLength allows for.
+	out += std::snprintf(out, 24, " %d %d", halfmove_clock_, fullmove_number_);
+	return static_cast<int>(out - buffer);
+}
+
+/**
+ * Works out which castling moves are still possible in principle: the king and that rook are on
+ * their starting squares and neither has moved. Whether castling is legal right now also depends
+ * on the squares between them, which is left to the move generator.
+ *
+ * @return: A mask of kWhiteKingSide, kWhiteQueenSide, kBlackKingSide and kBlackQueenSide.
+ */
+int ChessBoard::GetCastlingRights() const
+{
+	int rights = 0;
+	for (Color color : { Color::White, Color::Black })
+	{
+		int back_row = color == Color::White ? 7 : 0;
+		const ChessPiece& king = board_[back_row][4];
+		if (king.GetPiece() != Piece::King || king.GetColor() != color || king.GetHasMoved())
+		{
+			continue;
+		}
+		const ChessPiece& king_rook = board_[back_row][7];
+		const ChessPiece& queen_rook = board_[back_row][0];
+		if (king_rook.GetPiece() == Piece::Rook && king_rook.GetColor() == color && !king_rook.GetHasMoved())
+		{
+			rights |= color == Color::White ? kWhiteKingSide : kBlackKingSide;
+		}
+		if (queen_rook.GetPiece() == Piece::Rook && queen_rook.GetColor() == color && !queen_rook.GetHasMoved())
+		{
+			rights |= color == Color::White ? kWhiteQueenSide : kBlackQueenSide;
+		}
+	}
+	return rights;
+}
+
+/**
+ * Checks whether the current position has already occurred in this game. Only positions with the same
+ * side to move since the last capture or pawn move can repeat, so the search stops there.
+ *
+ * @return: True if the position has occurred before, false otherwise.
+ */
+bool ChessBoard::IsRepetition() const
+{
+	uint64_t hash = GetHash();
+	int history_size = static_cast<int>(history_.size());
+	int reversible_plies = halfmove_clock_ < history_size ? halfmove_clock_ : history_size;
+	// The key stored with each move is the position before it, so history_[size - n] is the position n moves ago.
+	for (int plies_back = 2; plies_back <= reversible_plies; plies_back += 2)
+	{
+		if (history_[history_size - plies_back].hash == hash)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * Makes a move in place and pushes an undo record so that it can be taken back with UnmakeMove.
+ * The move is not checked for validity. Castling also moves the rook, en passant removes the
+ * captured pawn, and promotions replace the pawn with the chosen piece. The players' king positions
+ * and check states are kept up to date.
+ *
+ * @param move: The move to make
+ * @return: None
+ */
+void ChessBoard::MakeMove(Move move)
+{
+	int start = move.GetStart();
+	int end = move.GetEnd();
+	ChessPiece moving_piece = GetPieceAt(start);
+	Color player_color = moving_piece.GetColor();
+	Color enemy_color = GetOppositeColor(player_color);
+	ChessPlayer& player = players_[player_color];
+	ChessPlayer& enemy = players_[enemy_color];
+
+	UndoRecord record;
+	record.move = move;
+	record.had_moved = moving_piece.GetHasMoved();
+	record.en_passant_square = en_passant_square_;
+	record.halfmove_clock = halfmove_clock_;
+	record.king_position = player.GetKingPosition();
+	record.white_in_check = players_[Color::White].GetIsInCheck();
+	record.black_in_check = players_[Color::Black].GetIsInCheck();
+	record.hash = GetHash();
+
+	// The pawn taken en passant is beside the end square rather than on it.
+	int captured_square = end;
+	if (move.GetType() == MoveType::EnPassant)
+	{
+		captured_square = player_color == Color::White ? end + 8 : end - 8;
+	}
+	record.captured = GetPieceAt(captured_square);
+	history_.push_back(record);
+
+	if (moving_piece.GetPiece() == Piece::Pawn || record.captured.GetPiece() != Piece::Empty)
+	{
+		halfmove_clock_ = 0;
+	}
+	else
+	{
+		halfmove_clock_++;
+	}
+	if (player_color == Color::Black)
+	{
+		fullmove_number_++;
+	}
+
+	ClearSquare(start);
+	ClearSquare(captured_square);
+	moving_piece.SetHasMoved(true);
+	if (move.GetType() == MoveType::Promotion)
+	{
+		moving_piece.SetPiece(move.GetPromotion());
+	}
+	PlacePiece(end, moving_piece);
+
+	if (move.GetType() == MoveType::Castling)
+	{
+		// The rook jumps from its corner to the square the king passed over.
+		int row = start / 8;
+		int rook_start = row * 8 + (end % 8 == 6 ? 7 : 0);
+		int rook_end = row * 8 + (end % 8 == 6 ? 5 : 3);
+		ChessPiece rook = GetPieceAt(rook_start);
+		rook.SetHasMoved(true);
+		ClearSquare(rook_start);
+		PlacePiece(rook_end, rook);
+	}
+
+	if (moving_piece.GetPiece() == Piece::King)
+	{
+		player.SetKingPosition(PositionOf(end));
+	}
+	if (moving_piece.GetPiece() == Piece::Pawn && (end - start == 16 || start - end == 16))
+	{
+		SetEnPassantSquare((start + end) / 2);
+	}
+	else
+	{
+		SetEnPassantSquare(kNoSquare);
+	}
+	SetSideToMove(enemy_color);
+
+	// A move never leaves its own king in check, but it may put the enemy king in check.
+	player.SetCheck(false);
+	Bitboard enemy_king = GetPieces(enemy_color, Piece::King);
+	enemy.SetCheck(enemy_king && IsSquareAttacked(*this, LowestSquare(enemy_king), player_color));
+}
+
+/**
+ * Takes back the last move made with MakeMove, restoring the board exactly as it was before it.
+ *
+ * @return: None
+ */
+void ChessBoard::UnmakeMove()
+{
+	UndoRecord record = history_.back();
+	history_.pop_back();
+	Move move = record.move;
+	int start = move.GetStart();
+	int end = move.GetEnd();
+	ChessPiece moving_piece = GetPieceAt(end);
+	Color player_color = moving_piece.GetColor();
+
+	if (move.GetType() == MoveType::Castling)
+	{
+		int row = start / 8;
+		int rook_start = row * 8 + (end % 8 == 6 ? 7 : 0);
+		int rook_end = row * 8 + (end % 8 == 6 ? 5 : 3);
+		ChessPiece rook = GetPieceAt(rook_end);
+		rook.SetHasMoved(false);
+		ClearSquare(rook_end);
+		PlacePiece(rook_start, rook);
+	}
+
+	moving_piece.SetHasMoved(record.had_moved);
+	if (move.GetType() == MoveType::Promotion)
+	{
+		moving_piece.SetPiece(Piece::Pawn);
+	}
+	ClearSquare(end);
+	PlacePiece(start, moving_piece);
+
+	int captured_square = end;
+	if (move.GetType() == MoveType::EnPassant)
+	{
+		captured_square = player_color == Color::White ? end + 8 : end - 8;
+	}
+	PlacePiece(captured_square, record.captured);
+
+	players_[player_color].SetKingPosition(record.king_position);
+	players_[Color::White].SetCheck(record.white_in_check);
+	players_[Color::Black].SetCheck(record.black_in_check);
+	en_passant_square_ = record.en_passant_square;
+	halfmove_clock_ = record.halfmove_clock;
+	if (player_color == Color::Black)
+	{
+		fullmove_number_--;
+	}
+	side_to_move_ = player_color;
+	// The castling rights are back to what they were, so the stored key can be split back into its parts.
+	hash_ = record.hash ^ CastlingKey(GetCastlingRights());
 }
 
 /**
@@ -34,15 +717,8 @@ void ChessBoard::PrintBoard()
  */
 bool ValidKnightMove(pair<int, int> start, pair<int, int> end)
 {
-	// Knight moves in 1 of 8 different possible L shapes.
-	return  (start.first == end.first + 1 && start.second == end.second + 2) ||
-		(start.first == end.first - 1 && start.second == end.second + 2) ||
-		(start.first == end.first + 1 && start.second == end.second - 2) ||
-		(start.first == end.first - 1 && start.second == end.second - 2) ||
-		(start.first == end.first + 2 && start.second == end.second + 1) ||
-		(start.first == end.first - 2 && start.second == end.second + 1) ||
-		(start.first == end.first + 2 && start.second == end.second - 1) ||
-		(start.first == end.first - 2 && start.second == end.second - 1);
+	// Knight moves in 1 of 8 different possible L shapes, all of which are in its attack table.
+	return (KnightAttacks(SquareOf(start)) & SquareBit(SquareOf(end))) != kEmptyBitboard;
 }
 
 /**
@@ -57,10 +733,7 @@ bool ValidKnightMove(pair<int, int> start, pair<int, int> end)
 bool ValidBishopMove(pair<int, int> start, pair<int, int> end)
 {
 	// Bishop moves diagonally
-	return (end.first - start.first == end.second - start.second) || 
-		(start.first - end.first == end.second - start.second) || 
-		(end.first - start.first == start.second - end.second) || 
-		(start.first - end.first == start.second - end.second);
+	return (kBishopRays[SquareOf(start)] & SquareBit(SquareOf(end))) != kEmptyBitboard;
 }
 
 /**
@@ -75,8 +748,7 @@ bool ValidBishopMove(pair<int, int> start, pair<int, int> end)
 bool ValidRookMove(pair<int, int> start, pair<int, int> end)
 {
 	// Rook only moves in straight lines in the X and Y direction
-	return (end.first - start.first != 0 && end.second - start.second == 0) ||
-		(end.first - start.first == 0 && end.second - start.second != 0);
+	return (kRookRays[SquareOf(start)] & SquareBit(SquareOf(end))) != kEmptyBitboard;
 }
 
 
@@ -92,26 +764,7 @@ bool ValidRookMove(pair<int, int> start, pair<int, int> end)
 bool ValidQueenMove(pair<int, int> start, pair<int, int> end)
 {
 	// Queen can move like a Rook or like a Bishop.
-	return ValidBishopMove(start, end) || ValidRookMove(start, end);
-}
-
-/**
- * Returns true if the piece moves 1 space in any of the possible 8 directions.
- * This function also makes sure that true is not returned if the
- * piece does not move at all. This is used in combination with ValidQueenMove
- * to check if a move for a king is valid.
- * 
- * @param start: The row and column of the piece to be moved
- * @param end: The row and column that the piece is to be moved to.
- * @return: True if the move is valid, false otherwise.
- * 
- */
-bool MovesOneSpace(pair<int, int> start, pair<int, int> end)
-{
-	
-	return !(end.first - start.first == 0 && end.second - start.second == 0) &&
-		((end.first - start.first == 1 || end.first - start.first == 0 || end.first - start.first == -1) &&
-		(end.second - start.second == 1 || end.second - start.second == 0 || end.second - start.second == -1));
+	return ((kBishopRays[SquareOf(start)] | kRookRays[SquareOf(start)]) & SquareBit(SquareOf(end))) != kEmptyBitboard;
 }
 
 /**
@@ -126,7 +779,7 @@ bool MovesOneSpace(pair<int, int> start, pair<int, int> end)
 bool ValidKingMove(pair<int, int> start, pair<int, int> end)
 {
 	// King can do whatever queen can as long as it only moves one space in the X and/or Y direction
-	return ValidQueenMove(start, end) && MovesOneSpace(start, end);
+	return (KingAttacks(SquareOf(start)) & SquareBit(SquareOf(end))) != kEmptyBitboard;
 }
 
 /**
@@ -140,9 +793,9 @@ bool ValidKingMove(pair<int, int> start, pair<int, int> end)
  * @param chess_board: The chess board. This is to check for collisions with other pieces when trying to move forward.
  * @return: True if the move is valid, false otherwise.
  */
-bool ValidPawnForwardOne(pair<int, int> start, pair<int, int> end, ChessPiece& chess_piece, ChessBoard& chess_board)
+bool ValidPawnForwardOne(pair<int, int> start, pair<int, int> end, const ChessPiece& chess_piece, const ChessBoard& chess_board)
 {
-	auto board = chess_board.GetBoard();
+	const auto& board = chess_board.GetBoard();
 	if (board.at(end.first).at(end.second).GetColor() != Color::Empty)
 	{
 		return false;
@@ -169,14 +822,14 @@ bool ValidPawnForwardOne(pair<int, int> start, pair<int, int> end, ChessPiece& c
  * @param chess_board: The chess board. This is to check for collisions with other pieces when trying to move forward.
  * @return: True if the move is valid, false otherwise.
  */
-bool ValidPawnForwardAll(pair<int, int> start, pair<int, int> end, ChessPiece& chess_piece, ChessBoard& chess_board)
+bool ValidPawnForwardAll(pair<int, int> start, pair<int, int> end, const ChessPiece& chess_piece, const ChessBoard& chess_board)
 {
 	/**
 	 * Pawns can move 1 or 2 spaces forward if they have not moved yet,
 	 * and only 1 if they already have.
 	 */
 
-	auto board = chess_board.GetBoard();
+	const auto& board = chess_board.GetBoard();
 
 	if (chess_piece.GetHasMoved() == false)
 	{
@@ -211,122 +864,32 @@ bool ValidPawnForwardAll(pair<int, int> start, pair<int, int> end, ChessPiece& c
  * pawns can move forward diagonally only if the spot they wish to move to is occupied by an enemy piece
  * @return: True if the move is valid, false otherwise.
  */
-bool ValidPawnMove(pair<int, int> start, pair<int, int> end, ChessPiece& chess_piece, ChessBoard& chess_board)
+bool ValidPawnMove(pair<int, int> start, pair<int, int> end, const ChessPiece& chess_piece, const ChessBoard& chess_board)
 {
 	if (chess_board.GetBoard().at(end.first).at(end.second).GetPiece() != Piece::Empty)
 	{
-		if (chess_piece.GetColor() == Color::White)
-		{
-			return (end.first == start.first - 1) && (end.second == start.second + 1 || end.second == start.second - 1)
-				|| ValidPawnForwardAll(start, end, chess_piece, chess_board);
-		}
-		else
-		{
-			return (end.first == start.first + 1) && (end.second == start.second + 1 || end.second == start.second - 1)
-				|| ValidPawnForwardAll(start, end, chess_piece, chess_board);
-		}
+		// A pawn takes one space diagonally forward, which is exactly its attack table entry.
+		return (PawnAttacks(chess_piece.GetColor(), SquareOf(start)) & SquareBit(SquareOf(end)))
+			|| ValidPawnForwardAll(start, end, chess_piece, chess_board);
 	}
 	return ValidPawnForwardAll(start, end, chess_piece, chess_board);
 }
 
-/**
- * Handles the iteration of the "movement" of pieces from start to end. Even though the piece is moved
- * instantly, the path is checked one space at a time to make sure that there are no collisions.
- * Each movement is handled based on a comparison between the start and end coordinates. Each time this function
- * is called, that piece is moved one space closer to the end in the x and/or y direction.
- *
- * @param end: The row and column that the piece is to be moved to.
- * @param current_position: The current position of the piece as it is moving along its path.
- * @return: None
- */
-void UpdatePosition(pair<int, int> end, pair<int, int>& current_position)
-{
-	if (current_position.first == end.first && current_position.second > end.second)
-	{
-		//Left
-		current_position.second--;
-	}
-	else if (current_position.first == end.first && current_position.second < end.second)
-	{
-		//Right
-		current_position.second++;
-	}
-	else if (current_position.first > end.first && current_position.second == end.second)
-	{
-		//Up
-		current_position.first--;
-	}
-	else if (current_position.first < end.first && current_position.second == end.second)
-	{
-		//Down
-		current_position.first++;
-	}
-	else if (current_position.first > end.first && current_position.second > end.second)
-	{
-		//Up and Left
-		current_position.first--;
-		current_position.second--;
-	}
-	else if (current_position.first < end.first && current_position.second > end.second)
-	{
-		//Down and Left
-		current_position.first++;
-		current_position.second--;
-	}
-	else if (current_position.first > end.first&& current_position.second < end.second)
-	{
-		//Up and Right
-		current_position.first--;
-		current_position.second++;
-	}
-	else if (current_position.first < end.first && current_position.second < end.second)
-	{
-		//Down and Right
-		current_position.first++;
-		current_position.second++;
-	}
-
-}
-
-/**
- * Checks to see if a piece has a certain color and type.
- * 
- * @return: A boolean representing whether or not the piece passed in has the desired color and type.
- */
-bool IsTargetPiece(ChessPiece& current_piece, Color desired_color, Piece desired_piece)
-{
-	return current_piece.GetColor() == desired_color && current_piece.GetPiece() == desired_piece;
-}
-
 /**
  * Checks to see if there is a collision along the path a piece wants to take from start to end.
+ * Only the squares strictly between start and end are checked; whether the end square itself
+ * may be taken is decided by CheckValidMove and the per-piece rules.
  *
- * @param chess_board: The chess board. This is used to identify the piece that the player wishes to take.
+ * @param chess_board: The chess board. Its occupancy bitboard is compared against the path.
  * @param start: The row and column of the piece to be moved
  * @param end: The row and column that the piece is to be moved to.
  *
  * @return: True if there is a collision, false otherwise.
  */
-bool CheckCollision(ChessBoard chess_board, pair<int, int> start, pair<int, int> end)
+bool CheckCollision(const ChessBoard& chess_board, pair<int, int> start, pair<int, int> end)
 {
-	auto current_position = start;
-	ChessPiece& end_piece = chess_board.GetBoard().at(end.first).at(end.second);
-	//Move one-by-one through the path until the destination is reached.
-	while (current_position.first != end.first || current_position.second != end.second)
-	{
-		UpdatePosition(end, current_position);
-		auto& current_piece = chess_board.GetBoard().at(current_position.first).at(current_position.second);
-		/**
-		 * Check to see if the current position holds a piece that is NOT the piece being held at the end coordinate.
-		 * This is to prevent the program from detecting collisions with the piece that one wishes to take.
-		 */
-		if (current_piece.GetPiece() != Piece::Empty && current_piece.GetColor() != Color::Empty
-			&& !IsTargetPiece(current_piece, end_piece.GetColor(), end_piece.GetPiece()))
-		{
-			return true;
-		}
-	}
-	return false;
+	CHESS_TIMED_PROBE(CheckCollision);
+	return (BetweenSquares(SquareOf(start), SquareOf(end)) & chess_board.GetOccupied()) != kEmptyBitboard;
 }
 
 /**
@@ -339,21 +902,19 @@ bool CheckCollision(ChessBoard chess_board, pair<int, int> start, pair<int, int>
  *
  * @return: True if the move is valid, false otherwise.
  */
-bool CheckValidMove(ChessPiece chess_piece, ChessBoard chess_board, pair<int, int> start, pair<int, int> end)
+bool CheckValidMove(const ChessPiece& chess_piece, const ChessBoard& chess_board, pair<int, int> start, pair<int, int> end)
 {
-	auto board = chess_board.GetBoard();
-	auto players = chess_board.players_;
-	Color piece_color = board.at(start.first).at(start.second).GetColor();
-	Color end_color = board.at(start.first).at(start.second).GetColor();
-	
-	// You can't move a piece to a square with another piece of the same color.
-	if (board.at(start.first).at(start.second).GetColor() == board.at(end.first).at(end.second).GetColor())
+	CHESS_TIMED_PROBE(CheckValidMove);
+	const auto& board = chess_board.GetBoard();
+
+	// A move is not valid if a piece is moved to a coordinate outside of the chess board.
+	if (end.first < 0 || end.first > 7 || end.second < 0 || end.second > 7)
 	{
 		return false;
 	}
 
-	// A move is not valid if a piece is moved to a coordinate outside of the chess board.
-	if (end.first < 0 || end.first > 7 || end.second < 0 || end.second > 7)
+	// You can't move a piece to a square with another piece of the same color.
+	if (board.at(start.first).at(start.second).GetColor() == board.at(end.first).at(end.second).GetColor())
 	{
 		return false;
 	}
@@ -400,7 +961,7 @@ bool CheckValidMove(ChessPiece chess_piece, ChessBoard chess_board, pair<int, in
  * @param
  * @return: The opposite color of the one passed in.
  */
-Color GetOppositeColor(Color& color)
+Color GetOppositeColor(Color color)
 {
 	switch (color)
 	{
@@ -415,6 +976,7 @@ Color GetOppositeColor(Color& color)
 
 /**
  * Decides whether or not the enemy king is in check, then update's the enemy's "is_in_check_" boolean if so.
+ * Nothing is printed here; the caller tells the player about the check.
  * @param enemy: The player whose king is checked for whether or not it is in check
  * @param chess_board: The chess_board
  * @return: True if the enemy is in check, false otherwise.
@@ -422,127 +984,115 @@ Color GetOppositeColor(Color& color)
 
 bool UpdateInCheck(ChessPlayer& enemy, ChessBoard& chess_board)
 {
-	auto board = chess_board.GetBoard();
+	CHESS_TIMED_PROBE(UpdateInCheck);
 	Color enemy_color = enemy.GetColor();
 	Color player_color = GetOppositeColor(enemy_color);
+	Bitboard enemy_king = chess_board.GetPieces(enemy_color, Piece::King);
+	if (enemy_king == kEmptyBitboard)
+	{
+		return false;
+	}
 
-
-	// Check every piece on the board.
-	for (int r = 0; r < 8; r++)
+	// Every one of the player's pieces that attacks the king, found with a handful of mask lookups.
+	Bitboard attackers = AttackersTo(chess_board, LowestSquare(enemy_king), chess_board.GetOccupied())
+		& chess_board.GetOccupancy(player_color);
+	if (attackers)
 	{
-		for (int c = 0; c < 8; c++)
-		{
-			ChessPiece& chess_piece = board.at(r).at(c);
-			/**
-			 * If the piece at the current space has the same color as the player, and
-			 * that piece has a valid path to the king, the enemy is in check.
-			 */
-			if (chess_piece.GetColor() == player_color && CheckValidMove(chess_piece,
-				chess_board, std::make_pair(r, c), enemy.GetKingPosition()))
-			{
-				cout << "Check!" << endl;
-				chess_board.players_[player_color].SetKingAttackPiece(std::make_pair(r, c));
-				return true;
-			}
-		}
+		chess_board.players_[player_color].SetKingAttackPiece(PositionOf(LowestSquare(attackers)));
+		return true;
 	}
 	return false;
 }
 
 /**
- * Checks to see if the enemy king has valid moves.
+ * Checks to see if the enemy king has valid moves. A square is safe for the king only if no enemy
+ * piece at all attacks it once the king has moved there, so every attacker is taken into account.
  *
  * @param enemy: The enemy player
  * @param chess_board: The chess board
- * @return: True if the 
+ * @return: True if the enemy king can move to at least one safe square, false otherwise.
  */
 bool KingHasValidMoves(ChessPlayer& enemy, ChessBoard& chess_board)
 {
-	auto board = chess_board.GetBoard();
-	auto king_position = enemy.GetKingPosition();
-	ChessPiece& enemy_king = board.at(king_position.first).at(king_position.second);
-	Color king_color = enemy_king.GetColor();
-	auto king_attack_piece = chess_board.players_[GetOppositeColor(king_color)].GetKingAttackPiece();
-
-	// Every possible space a king can move to
-	std::vector<pair<int, int>> moves{ std::make_pair(king_position.first, king_position.second + 1),
-	std::make_pair(king_position.first, king_position.second - 1),
-	std::make_pair(king_position.first + 1, king_position.second),
-	std::make_pair(king_position.first - 1, king_position.second),
-	std::make_pair(king_position.first + 1, king_position.second + 1),
-	std::make_pair(king_position.first + 1, king_position.second - 1),
-	std::make_pair(king_position.first - 1, king_position.second + 1),
-	std::make_pair(king_position.first - 1, king_position.second - 1) };
+	CHESS_TIMED_PROBE(KingHasValidMoves);
+	Color king_color = enemy.GetColor();
+	Bitboard king = chess_board.GetPieces(king_color, Piece::King);
+	if (king == kEmptyBitboard)
+	{
+		return false;
+	}
+	int king_square = LowestSquare(king);
 
-	/**
-	 * Check every possible move the king can make, and skip checking validity of moves that don't exist.
-	 * A move is valid in check if it meets 2 requirements:
-	 * 1. The move itself is valid
-	 * 2. The king is not still in check even after making the move.
-	 */
-	for (pair<int,int> end : moves)
+	// The king is lifted off the board so that it cannot block an attack along the line it is moving on.
+	Bitboard attacked = AttackedSquares(chess_board, GetOppositeColor(king_color), chess_board.GetOccupied() ^ king);
+	// Every space the king can step to that is neither held by one of its own pieces nor attacked.
+	Bitboard moves = KingAttacks(king_square) & ~chess_board.GetOccupancy(king_color) & ~attacked;
+	return moves != kEmptyBitboard;
+}
+
+
+/**
+ * Moves a piece from start to end, if that is a legal move. Castling is given as the king's move, and a
+ * pawn reaching the last rank becomes a queen.
+ *
+ * @param chess_board: The board
+ * @param start: The location of the piece before it is moved
+ * @param end: The location of the piece after it is moved
+ * @param tablebases: Tablebases to look the position up in before working out whether it is checkmate, or nullptr
+ * @return: True if checkmate is hit, false otherwise, including when the move is not legal and nothing is moved.
+ */
+bool MovePiece(ChessBoard& chess_board, pair<int, int> start, pair<int, int> end, const Tablebases* tablebases)
+{
+	MoveList move_list;
+	GenerateLegalMoves(chess_board, move_list);
+	for (Move move : move_list)
 	{
-		if (end.first < 0 || end.first > 7 || end.second < 0 || end.second > 7)
+		if (move.GetStart() == SquareOf(start) && move.GetEnd() == SquareOf(end)
+			&& (move.GetType() != MoveType::Promotion || move.GetPromotion() == Piece::Queen))
 		{
-			continue;
-		}
-		if (CheckValidMove(enemy_king, chess_board, king_position, end) && CheckValidMove(enemy_king, chess_board, king_attack_piece, end))
-		{
-			return true;
+			return MovePiece(chess_board, move, tablebases);
 		}
 	}
 	return false;
 }
 
-
 /**
- * Moves a piece from start to end
+ * Plays a move that is already known to be legal, such as one chosen by the computer player or taken
+ * from the legal move list, and updates the other player's check state.
  *
  * @param chess_board: The board
- * @param start: The location of the piece before it is moved
- * @param end: The location of the piece after it is moved
+ * @param move: The move to play
+ * @param tablebases: Tablebases to look the position up in before working out whether it is checkmate, or nullptr
  * @return: True if checkmate is hit, false otherwise
  */
-bool MovePiece(ChessBoard& chess_board, pair<int, int> start, pair<int, int> end)
+bool MovePiece(ChessBoard& chess_board, Move move, const Tablebases* tablebases)
 {
-	auto board = chess_board.GetBoard();
-	ChessPiece start_piece = board.at(start.first).at(start.second);
-	ChessPiece end_piece = board.at(end.first).at(end.second);
-	Color player_color = start_piece.GetColor();
-	Color enemy_color = GetOppositeColor(player_color);
-	ChessPlayer player = chess_board.players_[player_color];
-	ChessPlayer enemy = chess_board.players_[enemy_color];
+	CHESS_TIMED_PROBE(MovePiece);
+	Color enemy_color = GetOppositeColor(chess_board.GetPieceAt(move.GetStart()).GetColor());
 
 	/**
-	 * If the piece you are moving has not moved yet, update it.
-	 * This is to ensure That pawns can only move two tiles the first time they are moved.
-	 */
-	board.at(end.first).at(end.second).SetHasMoved(true);
-	
-	if (end_piece.GetPiece() == Piece::King)
-	{
-		return true;
-	}
-	/**
-	 * Set the end destination's piece to the start destination's piece, then set the start destination to empty.
+	 * Move the piece in place. This also marks it as moved, so that pawns can only move two tiles
+	 * the first time they are moved, and keeps the player's king position up to date.
 	 * Checking the validity of a move is done inside main.
 	 */
-	board.at(end.first).at(end.second).SetPiece(start_piece.GetPiece());
-	board.at(end.first).at(end.second).SetColor(start_piece.GetColor());
-	board.at(start.first).at(start.second).SetPiece(Piece::Empty);
-	board.at(start.first).at(start.second).SetColor(Color::Empty);
-	// Update the king's position if needed.
-	if (start_piece.GetPiece() == Piece::King)
-	{
-		player.SetKingPosition(end);
-	}
-	chess_board.SetBoard(board);
+	chess_board.MakeMove(move);
+
 	// See if the other player's king is in check, and update the player's check variable accordingly.
+	ChessPlayer& enemy = chess_board.players_[enemy_color];
 	enemy.SetCheck(UpdateInCheck(enemy, chess_board));
-	// If the enemy king is in check, see if the king has any valid moves. If it doesn't update checkmate.
+	// It is checkmate if the enemy king is in check and the enemy has no legal move at all: a king that can
+	// step out of check settles it quickly, and otherwise a piece may still block the check or take the checker.
 	if (enemy.GetIsInCheck() && !KingHasValidMoves(enemy, chess_board))
 	{
-		return true;
+		// A table that has the position already knows: checkmate is the only loss in 0 plies.
+		TablebaseProbe probe = tablebases != nullptr ? tablebases->Probe(chess_board) : TablebaseProbe();
+		if (probe.result != TablebaseResult::NotFound)
+		{
+			return probe.result == TablebaseResult::Loss && probe.distance == 0;
+		}
+		MoveList move_list;
+		GenerateLegalMoves(chess_board, move_list);
+		return move_list.Size() == 0;
 	}
 	return false;
-}
\ No newline at end of file
+}
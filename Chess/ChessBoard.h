@@ -1,6 +1,11 @@
 ﻿#pragma once
 #include "ChessPiece.h"
 #include "ChessPlayer.h"
+#include "Bitboard.h"
+#include "Move.h"
+#include "Network.h"
+#include "PieceSquareTables.h"
+#include "Zobrist.h"
 
 #include <array>
 using std::array;
@@ -8,52 +13,121 @@ using std::array;
 using std::pair;
 #include <vector>
 using std::vector;
-#include <map>
-using std::map;
 
-class ChessBoard
+class Tablebases;
+
+// The longest FEN string ToFEN can write, including the terminating null character.
+const int kMaxFENLength = 128;
+
+/**
+ * Everything MakeMove changes that cannot be worked out again from the move itself.
+ * UnmakeMove pops one of these to put the board back exactly as it was.
+ */
+struct UndoRecord
+{
+	Move move;
+	// The piece that was taken, including its has-moved flag. Empty if nothing was taken.
+	ChessPiece captured;
+	// Whether the moved piece had already moved before this move.
+	bool had_moved = false;
+	int en_passant_square = kNoSquare;
+	int halfmove_clock = 0;
+	// The moving player's king position before the move.
+	pair<int, int> king_position;
+	bool white_in_check = false;
+	bool black_in_check = false;
+	// The position's Zobrist key before the move.
+	uint64_t hash = 0;
+};
+
+/**
+ * The board is aligned to a cache line. The 8x8 board takes up the first line and the bitboards the second,
+ * so everything the rules and move generator read is in two cache lines.
+ */
+class alignas(64) ChessBoard
 {
 private:
 	// The board that is being used to play the game
 	array<array<ChessPiece, 8>, 8> board_;
-	// A board used to reset the board when a new game is started
-	array<array<ChessPiece, 8>, 8> start_{ {{ChessPiece(Color::Black, Piece::Rook),
-	ChessPiece(Color::Black, Piece::Knight), ChessPiece(Color::Black, Piece::Bishop),
-	ChessPiece(Color::Black, Piece::Queen), ChessPiece(Color::Black, Piece::King),
-	ChessPiece(Color::Black, Piece::Bishop), ChessPiece(Color::Black, Piece::Knight), ChessPiece(Color::Black, Piece::Rook)},
-	{ChessPiece(Color::Black, Piece::Pawn), ChessPiece(Color::Black, Piece::Pawn), ChessPiece(Color::Black, Piece::Pawn),
-	ChessPiece(Color::Black, Piece::Pawn), ChessPiece(Color::Black, Piece::Pawn), ChessPiece(Color::Black, Piece::Pawn),
-	ChessPiece(Color::Black, Piece::Pawn), ChessPiece(Color::Black, Piece::Pawn)},
-	{ChessPiece(Color::Empty, Piece::Empty), ChessPiece(Color::Empty, Piece::Empty), ChessPiece(Color::Empty, Piece::Empty),
-	ChessPiece(Color::Empty, Piece::Empty), ChessPiece(Color::Empty, Piece::Empty), ChessPiece(Color::Empty, Piece::Empty),
-	ChessPiece(Color::Empty, Piece::Empty), ChessPiece(Color::Empty, Piece::Empty)},
-	{ChessPiece(Color::Empty, Piece::Empty), ChessPiece(Color::Empty, Piece::Empty), ChessPiece(Color::Empty, Piece::Empty),
-	ChessPiece(Color::Empty, Piece::Empty), ChessPiece(Color::Empty, Piece::Empty), ChessPiece(Color::Empty, Piece::Empty),
-	ChessPiece(Color::Empty, Piece::Empty), ChessPiece(Color::Empty, Piece::Empty)},
-	{ChessPiece(Color::Empty, Piece::Empty), ChessPiece(Color::Empty, Piece::Empty), ChessPiece(Color::Empty, Piece::Empty),
-	ChessPiece(Color::Empty, Piece::Empty), ChessPiece(Color::Empty, Piece::Empty), ChessPiece(Color::Empty, Piece::Empty),
-	ChessPiece(Color::Empty, Piece::Empty), ChessPiece(Color::Empty, Piece::Empty)},
-	{ChessPiece(Color::Empty, Piece::Empty), ChessPiece(Color::Empty, Piece::Empty), ChessPiece(Color::Empty, Piece::Empty),
-	ChessPiece(Color::Empty, Piece::Empty), ChessPiece(Color::Empty, Piece::Empty), ChessPiece(Color::Empty, Piece::Empty),
-	ChessPiece(Color::Empty, Piece::Empty), ChessPiece(Color::Empty, Piece::Empty)},
-	{ChessPiece(Color::White, Piece::Pawn), ChessPiece(Color::White, Piece::Pawn), ChessPiece(Color::White, Piece::Pawn),
-	ChessPiece(Color::White, Piece::Pawn), ChessPiece(Color::White, Piece::Pawn), ChessPiece(Color::White, Piece::Pawn),
-	ChessPiece(Color::White, Piece::Pawn), ChessPiece(Color::White, Piece::Pawn)},
-	{ChessPiece(Color::White, Piece::Rook),ChessPiece(Color::White, Piece::Knight), ChessPiece(Color::White, Piece::Bishop),
-	ChessPiece(Color::White, Piece::Queen), ChessPiece(Color::White, Piece::King), ChessPiece(Color::White, Piece::Bishop),
-	ChessPiece(Color::White, Piece::Knight), ChessPiece(Color::White, Piece::Rook)}} };
+	// A board used to reset the board when a new game is started. It is shared by every board.
+	static const array<array<ChessPiece, 8>, 8> start_;
+
+	// One bitboard per piece type covering both colors, indexed by Piece minus one.
+	array<Bitboard, 6> pieces_{};
+	// Every square occupied by each color, indexed by ColorIndex.
+	array<Bitboard, 2> occupancy_{};
+
+	// The color of the player whose turn it is.
+	Color side_to_move_ = Color::White;
+	// The square a pawn skipped over with a two square move on the last turn, or kNoSquare.
+	int en_passant_square_ = kNoSquare;
+	// The number of moves made since the last capture or pawn move.
+	int halfmove_clock_ = 0;
+	// The number of the current full move, starting at 1 and increasing after each black move.
+	int fullmove_number_ = 1;
+	// The Zobrist key of the pieces, side to move and en passant file. Castling rights are added in GetHash.
+	uint64_t hash_ = 0;
+	// One record per move made with MakeMove, most recent last.
+	vector<UndoRecord> history_;
+	// The sum of kPieceSquareScores over every piece, and the game phase (see kPhaseWeights).
+	Score piece_square_score_;
+	int phase_ = 0;
+	// The network evaluating the board, if any, and its hidden layers for the pieces on the board. The hidden
+	// layers are only allocated while there is a network, so that boards without one stay small.
+	const Network* network_ = nullptr;
+	vector<Accumulator> accumulator_;
+
+	void SyncBitboards();
+	void AddPieceTerms(ChessPiece chess_piece, int square);
+	void RemovePieceTerms(ChessPiece chess_piece, int square);
 
 public:
 	ChessBoard() = default;
 	
-	map<Color, ChessPlayer> players_ = { std::make_pair(Color::White, ChessPlayer(Color::White)), std::make_pair(Color::Black, ChessPlayer(Color::Black)) };
-	array<array<ChessPiece, 8>, 8> GetBoard() { return board_; };
-
-
-	void SetBoard(array<array<ChessPiece, 8>, 8> board) { board_ = board; }
-	void Reset() { board_ = start_; };
-
-	void PrintBoard();
+	ChessPlayers players_;
+	const array<array<ChessPiece, 8>, 8>& GetBoard() const { return board_; };
+
+
+	void SetBoard(array<array<ChessPiece, 8>, 8> board) { board_ = board; SyncBitboards(); }
+	void Reset() { board_ = start_; side_to_move_ = Color::White; en_passant_square_ = kNoSquare; halfmove_clock_ = 0; fullmove_number_ = 1; history_.clear(); SyncBitboards(); };
+	bool FromFEN(const char* fen);
+	int ToFEN(char* buffer) const;
+
+	// The piece must not be Piece::Empty.
+	Bitboard GetPieces(Piece piece) const { return pieces_[static_cast<int>(piece) - 1]; }
+	Bitboard GetPieces(Color color, Piece piece) const { return GetPieces(piece) & GetOccupancy(color); }
+	Bitboard GetOccupancy(Color color) const { return occupancy_[ColorIndex(color)]; }
+	Bitboard GetOccupied() const { return occupancy_[0] | occupancy_[1]; }
+	const ChessPiece& GetPieceAt(int square) const { return board_[square / 8][square % 8]; }
+
+	Color GetSideToMove() const { return side_to_move_; }
+	int GetEnPassantSquare() const { return en_passant_square_; }
+	int GetHalfmoveClock() const { return halfmove_clock_; }
+	void SetHalfmoveClock(int halfmove_clock) { halfmove_clock_ = halfmove_clock; }
+	int GetFullmoveNumber() const { return fullmove_number_; }
+	void SetSideToMove(Color color);
+	void SetEnPassantSquare(int square);
+
+	int GetCastlingRights() const;
+	uint64_t GetHash() const { return hash_ ^ CastlingKey(GetCastlingRights()); }
+	bool IsRepetition() const;
+
+	Score GetPieceSquareScore() const { return piece_square_score_; }
+	int GetPhase() const { return phase_; }
+	// The network is not owned by the board and must outlive it. Copies of the board share it.
+	void SetNetwork(const Network* network) { network_ = network; accumulator_ = vector<Accumulator>(network != nullptr ? 1 : 0); SyncBitboards(); }
+	const Network* GetNetwork() const { return network_; }
+	// Only while there is a network.
+	const Accumulator& GetAccumulator() const { return accumulator_.front(); }
+
+	void PlacePiece(int square, ChessPiece chess_piece);
+	void ClearSquare(int square);
+
+	void MakeMove(Move move);
+	void UnmakeMove();
+	const vector<UndoRecord>& GetHistory() const { return history_; }
+
+	void PrintBoard() const;
 };
 
 bool ValidKnightMove(pair<int, int> start, pair<int, int> end);
@@ -66,24 +140,22 @@ bool ValidQueenMove(pair<int, int> start, pair<int, int> end);
 
 bool ValidKingMove(pair<int, int> start, pair<int, int> end);
 
-bool ValidPawnForwardOne(pair<int, int> start, pair<int, int> end, ChessPiece& chess_piece);
-
-bool ValidPawnForwardAll(pair<int, int> start, pair<int, int> end, ChessPiece& chess_piece);
+bool ValidPawnForwardOne(pair<int, int> start, pair<int, int> end, const ChessPiece& chess_piece, const ChessBoard& chess_board);
 
-bool ValidPawnMove(pair<int, int> start, pair<int, int> end, ChessPiece& chess_piece, ChessBoard& chess_board);
+bool ValidPawnForwardAll(pair<int, int> start, pair<int, int> end, const ChessPiece& chess_piece, const ChessBoard& chess_board);
 
-void UpdatePosition(pair<int, int> end, pair<int, int>& current_position);
+bool ValidPawnMove(pair<int, int> start, pair<int, int> end, const ChessPiece& chess_piece, const ChessBoard& chess_board);
 
-bool IsTargetPiece(ChessPiece& current_piece, Color desired_color, Piece desired_piece);
+bool CheckCollision(const ChessBoard& chess_board, pair<int, int> start, pair<int, int> end);
 
-bool CheckCollision(ChessBoard chess_board, pair<int, int> start, pair<int, int> end);
+bool CheckValidMove(const ChessPiece& chess_piece, const ChessBoard& chess_board, pair<int, int> start, pair<int, int> end);
 
-bool CheckValidMove(ChessPiece chess_piece, ChessBoard chess_board, pair<int, int> start, pair<int, int> end);
-
-Color GetOppositeColor(Color& color);
+Color GetOppositeColor(Color color);
 
 bool UpdateInCheck(ChessPlayer& enemy, ChessBoard& chess_board);
 
 bool KingHasValidMoves(ChessPlayer& enemy, ChessBoard& chess_board);
 
-bool MovePiece(ChessBoard& chess_board, pair<int, int> start, pair<int, int> end);
\ No newline at end of file
+bool MovePiece(ChessBoard& chess_board, pair<int, int> start, pair<int, int> end, const Tablebases* tablebases = nullptr);
+
+bool MovePiece(ChessBoard& chess_board, Move move, const Tablebases* tablebases = nullptr);
\ No newline at end of file
@@ -1 +1,262 @@
 ﻿#include "ChessGame.h"
+
+#include <chrono>
+#include <thread>
+
+#ifdef _WIN32
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+ChessGame::ChessGame()
+	: random_(static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count()))
+{
+	board_.Reset();
+	transposition_table_.Resize(kDefaultHashMB);
+	SetThreads(1);
+}
+
+ChessGame::~ChessGame()
+{
+	StopHelpers();
+}
+
+/**
+ * Sets the size of the transposition table, which also empties it.
+ *
+ * @param size_mb: The size of the table in megabytes
+ * @param use_huge_pages: Try to back the table with huge pages
+ * @return: True if the table was allocated, false if the memory was not available.
+ */
+bool ChessGame::SetHashSize(size_t size_mb, bool use_huge_pages)
+{
+	return transposition_table_.Resize(size_mb, use_huge_pages);
+}
+
+/**
+ * Binds a thread to one processor.
+ *
+ * @param thread: The thread to bind
+ * @param processor: The processor number. Wraps around if there are fewer processors.
+ * @return: None
+ */
+static void PinThread(std::thread& thread, int processor)
+{
+	unsigned processor_count = std::thread::hardware_concurrency();
+	if (processor_count == 0)
+	{
+		return;
+	}
+	processor %= processor_count;
+#ifdef _WIN32
+	if (processor < 64)
+	{
+		SetThreadAffinityMask(thread.native_handle(), DWORD_PTR(1) << processor);
+	}
+#elif defined(__linux__)
+	cpu_set_t cpu_set;
+	CPU_ZERO(&cpu_set);
+	CPU_SET(processor, &cpu_set);
+	pthread_setaffinity_np(thread.native_handle(), sizeof(cpu_set), &cpu_set);
+#else
+	(void)thread;
+#endif
+}
+
+/**
+ * Sets how many threads search each move. The helper threads are started here and wait for each search,
+ * rather than being started for every move. Must not be called while a search is running.
+ *
+ * @param count: The number of threads, at least 1
+ * @param pin_threads: Keep each helper thread on its own processor, which avoids the cost of threads
+ * migrating between cores. Only worth it when nothing else is running on the machine. The first thread
+ * runs on the caller's thread, which is left where it is.
+ * @return: None
+ */
+void ChessGame::SetThreads(int count, bool pin_threads)
+{
+	StopHelpers();
+	threads_.clear();
+	for (int id = 0; id < (count > 0 ? count : 1); id++)
+	{
+		threads_.push_back(unique_ptr<SearchThread>(new SearchThread(id, transposition_table_, tablebases_, stop_)));
+	}
+	uint64_t generation;
+	{
+		std::lock_guard<std::mutex> lock(helper_mutex_);
+		helpers_quit_ = false;
+		generation = search_generation_;
+	}
+	for (size_t i = 1; i < threads_.size(); i++)
+	{
+		SearchThread* search_thread = threads_[i].get();
+		// A new helper waits for the next search, not one that finished before it was started.
+		helpers_.emplace_back([this, search_thread, generation]() { RunHelper(search_thread, generation); });
+		if (pin_threads)
+		{
+			PinThread(helpers_.back(), search_thread->GetId());
+		}
+	}
+}
+
+/**
+ * Ends and joins the helper threads.
+ *
+ * @return: None
+ */
+void ChessGame::StopHelpers()
+{
+	{
+		std::lock_guard<std::mutex> lock(helper_mutex_);
+		helpers_quit_ = true;
+	}
+	helper_start_.notify_all();
+	for (std::thread& helper : helpers_)
+	{
+		helper.join();
+	}
+	helpers_.clear();
+}
+
+/**
+ * The loop of a helper thread: waits for a search to start, searches until it is stopped, and waits again.
+ *
+ * @param search_thread: The search thread it runs
+ * @param generation: The number of the last search started before the helper was
+ * @return: None
+ */
+void ChessGame::RunHelper(SearchThread* search_thread, uint64_t generation)
+{
+	std::unique_lock<std::mutex> lock(helper_mutex_);
+	for (;;)
+	{
+		helper_start_.wait(lock, [&]() { return helpers_quit_ || search_generation_ != generation; });
+		if (helpers_quit_)
+		{
+			return;
+		}
+		generation = search_generation_;
+		lock.unlock();
+		search_thread->Run(board_, limits_, search_start_);
+		lock.lock();
+		if (--helpers_running_ == 0)
+		{
+			helper_done_.notify_all();
+		}
+	}
+}
+
+/**
+ * Forgets what earlier searches learned, the transposition table and every thread's history scores, so
+ * that the next game is played the same way whatever was played before it. Must not be called while a
+ * search is running.
+ *
+ * @return: None
+ */
+void ChessGame::NewGame()
+{
+	transposition_table_.Clear();
+	for (auto& search_thread : threads_)
+	{
+		search_thread->ClearHistory();
+	}
+}
+
+/**
+ * Switches the computer player's evaluation to a network, or back to the built in evaluation. Must not be
+ * called while a search is running.
+ *
+ * @param path: The network file (see Network), or an empty path for the built in evaluation
+ * @return: True if the network was loaded, false if it could not be read, which also goes back to the built in evaluation.
+ */
+bool ChessGame::LoadNetwork(const string& path)
+{
+	bool loaded = !path.empty() && network_.Load(path);
+	board_.SetNetwork(loaded ? &network_ : nullptr);
+	return loaded;
+}
+
+/**
+ * Starts finding the computer player's move. A position in the opening book or the tablebases is answered
+ * straight from there with a depth of 0 and no search. Otherwise the helper threads start searching the
+ * position with iterative deepening (see SearchThread::Run), and the first thread joins them in FinishSearch.
+ * A Stop from before this call is forgotten, and one from after it stops this search. The board must not
+ * change until FinishSearch returns.
+ *
+ * @param limits: How long and how deep to search
+ * @return: None
+ */
+void ChessGame::StartSearch(const SearchLimits& limits)
+{
+	search_start_ = std::chrono::steady_clock::now();
+	stop_.store(false, std::memory_order_relaxed);
+	answered_ = false;
+	if (book_.IsOpen())
+	{
+		answer_ = SearchResult();
+		answer_.best_move = book_.PickMove(board_, random_());
+		answered_ = answer_.best_move != Move();
+	}
+	TablebaseProbe probe;
+	Move tablebase_move = answered_ ? Move() : tablebases_.FindBestMove(board_, probe);
+	if (tablebase_move != Move())
+	{
+		answer_ = SearchResult();
+		answer_.best_move = tablebase_move;
+		answer_.score = TablebaseScore(probe, 0);
+		answered_ = true;
+	}
+	if (answered_)
+	{
+		answer_.time_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - search_start_).count();
+		return;
+	}
+
+	limits_ = limits;
+	transposition_table_.NewSearch();
+	{
+		std::lock_guard<std::mutex> lock(helper_mutex_);
+		search_generation_++;
+		helpers_running_ = static_cast<int>(helpers_.size());
+	}
+	helper_start_.notify_all();
+}
+
+/**
+ * Runs the first search thread on the calling thread until it finishes or runs out of time, which stops
+ * the helpers, and waits for them. The move played comes from whichever thread completed the deepest
+ * iteration, so it always arrives within the budget. May be called from another thread than StartSearch.
+ *
+ * @return: The chosen move and details of the search, with the nodes of every thread added together.
+ */
+SearchResult ChessGame::FinishSearch()
+{
+	if (answered_)
+	{
+		return answer_;
+	}
+	threads_[0]->Run(board_, limits_, search_start_);
+	{
+		std::unique_lock<std::mutex> lock(helper_mutex_);
+		helper_done_.wait(lock, [&]() { return helpers_running_ == 0; });
+	}
+
+	SearchResult result = threads_[0]->GetResult();
+	uint64_t nodes = 0;
+	for (auto& search_thread : threads_)
+	{
+		const SearchResult& thread_result = search_thread->GetResult();
+		nodes += thread_result.nodes;
+		if (thread_result.depth > result.depth)
+		{
+			result.best_move = thread_result.best_move;
+			result.score = thread_result.score;
+			result.depth = thread_result.depth;
+		}
+	}
+	result.nodes = nodes;
+	result.time_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - search_start_).count();
+	return result;
+}
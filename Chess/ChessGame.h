@@ -1,13 +1,86 @@
 ﻿#pragma once
 #include "ChessPiece.h"
 #include "ChessBoard.h"
+#include "Network.h"
+#include "OpeningBook.h"
+#include "SearchThread.h"
+#include "Tablebase.h"
+#include "TranspositionTable.h"
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+using std::unique_ptr;
+#include <random>
+#include <mutex>
+#include <string>
+using std::string;
+#include <thread>
+#include <vector>
+using std::vector;
+
+// The transposition table size used until SetHashSize is called.
+const size_t kDefaultHashMB = 16;
 
 class ChessGame
 {
 private:
 	ChessBoard board_;
+	TranspositionTable transposition_table_;
+	vector<unique_ptr<SearchThread>> threads_;
+	// Set to stop every search thread.
+	std::atomic<bool> stop_{ false };
+	// The helper threads, which wait for a search between moves. threads_[i + 1] runs on helpers_[i], and
+	// threads_[0] runs on the thread that calls FinishSearch.
+	vector<std::thread> helpers_;
+	std::mutex helper_mutex_;
+	std::condition_variable helper_start_;
+	std::condition_variable helper_done_;
+	// Counts the searches started, so that a waiting helper can tell a new one has begun.
+	uint64_t search_generation_ = 0;
+	int helpers_running_ = 0;
+	bool helpers_quit_ = false;
+	// The search in progress, between StartSearch and FinishSearch.
+	SearchLimits limits_;
+	std::chrono::steady_clock::time_point search_start_;
+	// Set when StartSearch found the move in the book or the tablebases, so there is nothing to search.
+	bool answered_ = false;
+	SearchResult answer_;
+	OpeningBook book_;
+	// Chooses between book moves, so that games do not all follow the same line.
+	std::mt19937_64 random_;
+	Tablebases tablebases_;
+	Network network_;
+
+	void StopHelpers();
+	void RunHelper(SearchThread* search_thread, uint64_t generation);
 	
 public:
-	
+	ChessGame();
+	~ChessGame();
+
+	ChessBoard& GetBoard() { return board_; }
+	const ChessBoard& GetBoard() const { return board_; }
+
+	bool SetHashSize(size_t size_mb, bool use_huge_pages = false);
+	void ClearHash() { transposition_table_.Clear(); }
+	void NewGame();
+	void SetThreads(int count, bool pin_threads = false);
+	int GetThreads() const { return static_cast<int>(threads_.size()); }
+	bool OpenBook(const string& path) { return book_.Open(path); }
+	void CloseBook() { book_.Close(); }
+	// Replaces the open tablebases with those in the directory, or none for an empty path. Must not be called
+	// while a search is running.
+	int OpenTablebases(const string& directory) { tablebases_ = Tablebases(); return directory.empty() ? 0 : tablebases_.Open(directory); }
+	const Tablebases& GetTablebases() const { return tablebases_; }
+	bool LoadNetwork(const string& path);
+
+	void StartSearch(const SearchLimits& limits);
+	SearchResult FinishSearch();
+	SearchResult FindBestMove(const SearchLimits& limits) { StartSearch(limits); return FinishSearch(); }
+	// May be called from another thread to end the search in progress early. A call after StartSearch always
+	// reaches that search, even if FinishSearch has not started yet.
+	void Stop() { stop_.store(true, std::memory_order_relaxed); }
 };
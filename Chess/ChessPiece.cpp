@@ -8,7 +8,7 @@
  * @param chess_piece: The chess piece that is used to determine what is printed
  * @return: The ostream& that will be used for printing.
  */
-ostream& operator<<(ostream& out, ChessPiece& chess_piece)
+ostream& operator<<(ostream& out, const ChessPiece& chess_piece)
 {
 	Color color = chess_piece.GetColor();
 	Piece piece = chess_piece.GetPiece();
@@ -56,7 +56,7 @@ ostream& operator<<(ostream& out, ChessPiece& chess_piece)
  * @param chess_piece: The color that is used to determine what is printed
  * @return: The ostream& that will be used for printing.
  */
-ostream& operator<<(ostream& out, Color& color)
+ostream& operator<<(ostream& out, const Color& color)
 {
 	switch (color)
 	{
@@ -81,7 +81,7 @@ ostream& operator<<(ostream& out, Color& color)
  * @return: The ostream& that will be used for printing.
  */
 
-ostream& operator<<(ostream& out, Piece& piece)
+ostream& operator<<(ostream& out, const Piece& piece)
 {
 	switch (piece)
 	{
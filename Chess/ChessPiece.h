@@ -7,34 +7,49 @@ using std::endl;
 using std::ostream;
 #include <string>
 using std::string;
+#include <cstdint>
 
 enum class Color { Black = -1, White = 1, Empty = 0};
 enum class Piece { Empty, Pawn, Knight, Bishop, Rook, Queen, King };
 
+// Index used for tables that are kept per color. White is 0 and Black is 1.
+constexpr int ColorIndex(Color color) { return color == Color::White ? 0 : 1; }
+
+/**
+ * A piece packed into a single byte so that a whole board fits in one cache line.
+ * Bits 0-2 hold the Piece, bits 3-4 hold the Color plus one (so Black is 0, Empty is 1 and White is 2),
+ * and bit 5 is set once the piece has moved.
+ */
 class ChessPiece
 {
 private:
-	Color color_ = Color::Empty;
-	Piece piece_ = Piece::Empty;
-	bool has_moved_ = false;
+	static constexpr int kColorShift = 3;
+	static constexpr uint8_t kPieceMask = 0x07;
+	static constexpr uint8_t kColorMask = 0x18;
+	static constexpr uint8_t kMovedFlag = 0x20;
+
+	uint8_t data_ = (static_cast<int>(Color::Empty) + 1) << kColorShift;
 	
 public:
-	ChessPiece() = default;
-	ChessPiece(Color color, Piece piece) : color_(color), piece_(piece) {}
+	constexpr ChessPiece() = default;
+	constexpr ChessPiece(Color color, Piece piece)
+		: data_(static_cast<uint8_t>(((static_cast<int>(color) + 1) << kColorShift) | static_cast<int>(piece))) {}
 
 	//Setters
-	void SetColor(Color color) { color_ = color; }
-	void SetPiece(Piece piece) { piece_ = piece; }
-	void SetHasMoved(bool has_moved) { has_moved_ = has_moved; }
+	void SetColor(Color color) { data_ = static_cast<uint8_t>((data_ & ~kColorMask) | ((static_cast<int>(color) + 1) << kColorShift)); }
+	void SetPiece(Piece piece) { data_ = static_cast<uint8_t>((data_ & ~kPieceMask) | static_cast<int>(piece)); }
+	void SetHasMoved(bool has_moved) { data_ = static_cast<uint8_t>(has_moved ? data_ | kMovedFlag : data_ & ~kMovedFlag); }
 	
 	//Accessors
-	Color GetColor() { return color_; }
-	Piece GetPiece() { return piece_; }
-	bool GetHasMoved() { return has_moved_; }
-};	
+	constexpr Color GetColor() const { return static_cast<Color>(((data_ & kColorMask) >> kColorShift) - 1); }
+	constexpr Piece GetPiece() const { return static_cast<Piece>(data_ & kPieceMask); }
+	constexpr bool GetHasMoved() const { return (data_ & kMovedFlag) != 0; }
+};
+
+static_assert(sizeof(ChessPiece) == 1, "ChessPiece should pack into one byte");
 
-ostream& operator<<(ostream& out, ChessPiece& chess_piece);
+ostream& operator<<(ostream& out, const ChessPiece& chess_piece);
 
-ostream& operator<<(ostream& out, Color& color);
+ostream& operator<<(ostream& out, const Color& color);
 
-ostream& operator<<(ostream& out, Piece& piece);
\ No newline at end of file
+ostream& operator<<(ostream& out, const Piece& piece);
\ No newline at end of file
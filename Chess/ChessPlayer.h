@@ -1,9 +1,10 @@
 #pragma once
-#include <map>
-
 #include "ChessPiece.h"
 
-using std::map;
+#include <array>
+using std::array;
+#include <utility>
+
 class ChessPlayer
 {
 private:
@@ -11,14 +12,12 @@ private:
 	bool is_in_check_ = false;
 	bool king_taken = false;
 	std::pair<int,int> king_attack_piece_;
-	
-	map<Color, int> default_king_rows_ = { {Color::White, 7}, {Color::Black, 0} };
 	std::pair<int, int> king_position_;
 
 public:
 	// A player can be initialized either with no parameters, or with a color.
 	ChessPlayer() = default;
-	ChessPlayer(Color color) { color_ = color, king_position_ = std::make_pair(default_king_rows_[color_], 4); }
+	ChessPlayer(Color color) { color_ = color, king_position_ = std::make_pair(color == Color::White ? 7 : 0, 4); }
 
 	Color GetColor() { return color_; }
 	std::pair<int, int> GetKingPosition() { return king_position_; }
@@ -28,4 +27,18 @@ public:
 	void SetKingPosition(std::pair<int, int> king_position) { king_position_ = king_position; }
 	void SetCheck(bool check) { is_in_check_ = check; }
 	void SetKingAttackPiece(std::pair<int,int> king_attack_piece) { king_attack_piece_ = king_attack_piece; }
+};
+
+/**
+ * The two players of a game, looked up by color. This replaces a map so that the players are stored
+ * inline with the board instead of in separately allocated nodes.
+ */
+class ChessPlayers
+{
+private:
+	array<ChessPlayer, 2> players_{ { ChessPlayer(Color::White), ChessPlayer(Color::Black) } };
+
+public:
+	ChessPlayer& operator[](Color color) { return players_[ColorIndex(color)]; }
+	const ChessPlayer& operator[](Color color) const { return players_[ColorIndex(color)]; }
 };
\ No newline at end of file
@@ -0,0 +1,130 @@
+#include "Evaluation.h"
+#include "Magic.h"
+
+/**
+ * @param chess_board: The position
+ * @param color: The side whose pawns attack
+ * @return: Every square attacked by that side's pawns.
+ */
+static Bitboard PawnAttackSquares(const ChessBoard& chess_board, Color color)
+{
+	Bitboard attacks = kEmptyBitboard;
+	Bitboard pawns = chess_board.GetPieces(color, Piece::Pawn);
+	while (pawns)
+	{
+		attacks |= PawnAttacks(color, PopLowestSquare(pawns));
+	}
+	return attacks;
+}
+
+/**
+ * Scores how freely one side's pieces move and how hard they attack the enemy king. A piece scores for each
+ * square it attacks that is neither its own side's nor guarded by an enemy pawn. The king's danger grows with
+ * the square of the attack weight on the squares around it, once at least two pieces join in, since a lone
+ * attacker is rarely dangerous.
+ *
+ * @param chess_board: The position
+ * @param color: The side to score
+ * @return: The score from that side's point of view.
+ */
+static Score EvaluateActivity(const ChessBoard& chess_board, Color color)
+{
+	Color enemy = GetOppositeColor(color);
+	Bitboard occupied = chess_board.GetOccupied();
+	Bitboard mobility_area = ~chess_board.GetOccupancy(color) & ~PawnAttackSquares(chess_board, enemy);
+	Bitboard enemy_king = chess_board.GetPieces(enemy, Piece::King);
+	Bitboard king_zone = enemy_king ? KingAttacks(LowestSquare(enemy_king)) | enemy_king : kEmptyBitboard;
+
+	Score score;
+	int attackers = 0;
+	int attack_weight = 0;
+	for (Piece piece : { Piece::Knight, Piece::Bishop, Piece::Rook, Piece::Queen })
+	{
+		Bitboard pieces = chess_board.GetPieces(color, piece);
+		while (pieces)
+		{
+			int square = PopLowestSquare(pieces);
+			Bitboard attacks = piece == Piece::Knight ? KnightAttacks(square)
+				: piece == Piece::Bishop ? BishopAttacks(square, occupied)
+				: piece == Piece::Rook ? RookAttacks(square, occupied)
+				: QueenAttacks(square, occupied);
+			int index = static_cast<int>(piece);
+			score += kMobilityWeights[index] * (PopCount(attacks & mobility_area) - kMobilityBaseline[index]);
+			if (attacks & king_zone)
+			{
+				attackers++;
+				attack_weight += kKingAttackWeights[index] * PopCount(attacks & king_zone);
+			}
+		}
+	}
+	if (attackers >= 2)
+	{
+		int danger = attack_weight * attack_weight / 2;
+		score.mg += danger < kMaxKingDanger ? danger : kMaxKingDanger;
+	}
+	return score;
+}
+
+/**
+ * Scores the pawns in front of one side's king, which keep enemy pieces away from it in the middlegame.
+ *
+ * @param chess_board: The position
+ * @param color: The side whose king is scored
+ * @return: The score from that side's point of view.
+ */
+static Score EvaluatePawnShield(const ChessBoard& chess_board, Color color)
+{
+	Bitboard king = chess_board.GetPieces(color, Piece::King);
+	if (!king)
+	{
+		return Score();
+	}
+	int king_square = LowestSquare(king);
+	int row = king_square / 8;
+	int column = king_square % 8;
+	// White's pawns are in front of its king on the rows above it, which have lower numbers.
+	int forward = color == Color::White ? -1 : 1;
+	Bitboard pawns = chess_board.GetPieces(color, Piece::Pawn);
+	Score score;
+	for (int distance = 1; distance <= 2; distance++)
+	{
+		int shield_row = row + forward * distance;
+		if (shield_row < 0 || shield_row > 7)
+		{
+			break;
+		}
+		for (int shield_column = column - 1; shield_column <= column + 1; shield_column++)
+		{
+			if (shield_column >= 0 && shield_column <= 7 && (pawns & SquareBit(shield_row * 8 + shield_column)))
+			{
+				score.mg += distance == 1 ? kPawnShieldNear : kPawnShieldFar;
+			}
+		}
+	}
+	return score;
+}
+
+/**
+ * Scores a position statically, without looking at any moves. With a network loaded on the board the network
+ * decides. Otherwise the score is the material and piece-square total the board keeps up to date as moves are made,
+ * plus each side's mobility and king safety. The middlegame and endgame scores are blended by the game phase.
+ *
+ * @param chess_board: The position to score
+ * @return: The score in hundredths of a pawn from the point of view of the side to move. Positive scores favor the side to move.
+ */
+int Evaluate(const ChessBoard& chess_board)
+{
+	Color us = chess_board.GetSideToMove();
+	if (const Network* network = chess_board.GetNetwork())
+	{
+		return network->Evaluate(chess_board.GetAccumulator(), us);
+	}
+
+	Score score = chess_board.GetPieceSquareScore()
+		+ EvaluateActivity(chess_board, Color::White) - EvaluateActivity(chess_board, Color::Black)
+		+ EvaluatePawnShield(chess_board, Color::White) - EvaluatePawnShield(chess_board, Color::Black);
+	// Promotions can take the phase past its starting value.
+	int phase = chess_board.GetPhase() < kMaxPhase ? chess_board.GetPhase() : kMaxPhase;
+	int blended = (score.mg * phase + score.eg * (kMaxPhase - phase)) / kMaxPhase;
+	return us == Color::White ? blended : -blended;
+}
@@ -0,0 +1,21 @@
+#pragma once
+#include "ChessBoard.h"
+
+#include <array>
+using std::array;
+
+// The value of each piece in hundredths of a pawn, indexed by Piece. The king is never traded, so it has no value.
+const array<int, 7> kPieceValues = { 0, 100, 320, 330, 500, 900, 0 };
+
+// Indexed by Piece: what each square a piece can move to is worth, and how many squares it is expected to have.
+const array<Score, 7> kMobilityWeights = { Score(0, 0), Score(0, 0), Score(4, 4), Score(5, 5), Score(2, 4), Score(1, 2), Score(0, 0) };
+const array<int, 7> kMobilityBaseline = { 0, 0, 4, 6, 7, 13, 0 };
+// Indexed by Piece: how much each attack on the squares around the enemy king adds to the danger it is in.
+const array<int, 7> kKingAttackWeights = { 0, 0, 2, 2, 3, 5, 0 };
+// The most the king's danger can cost, in the middlegame.
+const int kMaxKingDanger = 500;
+// Own pawns one and two squares in front of the king, in the middlegame.
+const int kPawnShieldNear = 12;
+const int kPawnShieldFar = 6;
+
+int Evaluate(const ChessBoard& chess_board);
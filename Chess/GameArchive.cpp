@@ -0,0 +1,331 @@
+#include "GameArchive.h"
+
+#include <cstring>
+
+// Results are stored as an index into this table.
+static const char* const kResults[4] = { "*", "1-0", "0-1", "1/2-1/2" };
+
+/**
+ * Appends a number to a buffer in little-endian order.
+ *
+ * @param buffer: The buffer to append to
+ * @param value: The number
+ * @param bytes: How many bytes of the number to write
+ * @return: None
+ */
+static void PutNumber(vector<unsigned char>& buffer, uint64_t value, int bytes)
+{
+	for (int i = 0; i < bytes; i++)
+	{
+		buffer.push_back(static_cast<unsigned char>(value >> (8 * i)));
+	}
+}
+
+/**
+ * Reads a little-endian number, whatever the alignment of the data.
+ *
+ * @param data: The first byte of the number
+ * @param bytes: How many bytes the number takes
+ * @return: The number.
+ */
+static uint64_t GetNumber(const unsigned char* data, int bytes)
+{
+	uint64_t value = 0;
+	for (int i = bytes - 1; i >= 0; i--)
+	{
+		value = value << 8 | data[i];
+	}
+	return value;
+}
+
+/**
+ * Builds the 32 byte header of an archive.
+ *
+ * @return: The header.
+ */
+static vector<unsigned char> MakeHeader(bool store_hashes, uint64_t game_count, uint64_t index_offset)
+{
+	vector<unsigned char> header(kArchiveMagic, kArchiveMagic + sizeof(kArchiveMagic));
+	PutNumber(header, kArchiveVersion, 4);
+	PutNumber(header, store_hashes ? kArchiveHasHashes : 0, 4);
+	PutNumber(header, game_count, 8);
+	PutNumber(header, index_offset, 8);
+	return header;
+}
+
+uint64_t ArchivedGame::GetHash(int ply) const
+{
+	return GetNumber(hashes + 8 * ply, 8);
+}
+
+/**
+ * Creates an archive, replacing any file at the path. A placeholder header is written now and filled in by Close.
+ *
+ * @param path: The file to write
+ * @param store_hashes: Whether to store the hash of every position of every game
+ * @return: True if the file was created, false otherwise.
+ */
+bool GameArchiveWriter::Open(const string& path, bool store_hashes)
+{
+	Close();
+	file_.open(path, std::ios::binary | std::ios::trunc);
+	if (!file_)
+	{
+		return false;
+	}
+	store_hashes_ = store_hashes;
+	offsets_.clear();
+	vector<unsigned char> header = MakeHeader(store_hashes, 0, 0);
+	file_.write(reinterpret_cast<const char*>(header.data()), header.size());
+	position_ = header.size();
+	return static_cast<bool>(file_);
+}
+
+/**
+ * Writes a finished game. The moves and hashes come straight from the board's move history, so any game
+ * played through MakeMove or MovePiece can be saved as it stands.
+ *
+ * @param chess_board: The board at the end of the game, with every move of the game in its history
+ * @param result: "1-0", "0-1", "1/2-1/2" or "*"
+ * @param start_fen: The position the game started from, or empty for the normal start position
+ * @return: True if the game was written, false if the file could not be written or the game is too long.
+ */
+bool GameArchiveWriter::WriteGame(const ChessBoard& chess_board, const string& result, const string& start_fen)
+{
+	const vector<UndoRecord>& history = chess_board.GetHistory();
+	if (!file_.is_open() || history.size() > 0xFFFF || start_fen.size() > 0xFF)
+	{
+		return false;
+	}
+	int result_code = 0;
+	for (int i = 0; i < 4; i++)
+	{
+		result_code = result == kResults[i] ? i : result_code;
+	}
+
+	record_.clear();
+	PutNumber(record_, history.size(), 2);
+	PutNumber(record_, result_code, 1);
+	PutNumber(record_, start_fen.empty() ? 0 : 1, 1);
+	if (!start_fen.empty())
+	{
+		PutNumber(record_, start_fen.size(), 1);
+		record_.insert(record_.end(), start_fen.begin(), start_fen.end());
+	}
+	for (const UndoRecord& record : history)
+	{
+		PutNumber(record_, record.move.GetData(), 2);
+	}
+	if (store_hashes_)
+	{
+		for (const UndoRecord& record : history)
+		{
+			PutNumber(record_, record.hash, 8);
+		}
+		PutNumber(record_, chess_board.GetHash(), 8);
+	}
+
+	offsets_.push_back(position_);
+	file_.write(reinterpret_cast<const char*>(record_.data()), record_.size());
+	position_ += record_.size();
+	return static_cast<bool>(file_);
+}
+
+/**
+ * Writes a game read from PGN. Its moves are replayed to rebuild the board's history.
+ *
+ * @param game: The game, whose moves must be legal
+ * @return: True if the game was written, false otherwise.
+ */
+bool GameArchiveWriter::WriteGame(const PgnGame& game)
+{
+	ChessBoard chess_board;
+	chess_board.Reset();
+	if (!game.fen.empty() && !chess_board.FromFEN(game.fen.c_str()))
+	{
+		return false;
+	}
+	for (Move move : game.moves)
+	{
+		chess_board.MakeMove(move);
+	}
+	return WriteGame(chess_board, game.result, game.fen);
+}
+
+/**
+ * Writes the index and the final header and closes the file. Does nothing if no file is open.
+ *
+ * @return: True if the archive is complete, false if it could not be written.
+ */
+bool GameArchiveWriter::Close()
+{
+	if (!file_.is_open())
+	{
+		return true;
+	}
+	vector<unsigned char> index;
+	index.reserve(offsets_.size() * 8);
+	for (uint64_t offset : offsets_)
+	{
+		PutNumber(index, offset, 8);
+	}
+	file_.write(reinterpret_cast<const char*>(index.data()), index.size());
+	vector<unsigned char> header = MakeHeader(store_hashes_, offsets_.size(), position_);
+	file_.seekp(0);
+	file_.write(reinterpret_cast<const char*>(header.data()), header.size());
+	bool written = static_cast<bool>(file_);
+	file_.close();
+	return written;
+}
+
+/**
+ * Maps an archive into memory and checks its header and index.
+ *
+ * @param path: The archive to open
+ * @return: True if the archive was opened, false if it is missing, not an archive or cut short.
+ */
+bool GameArchive::Open(const string& path)
+{
+	game_count_ = 0;
+	if (!file_.Open(path) || file_.GetSize() < kArchiveHeaderSize)
+	{
+		return false;
+	}
+	data_ = reinterpret_cast<const unsigned char*>(file_.GetData());
+	if (std::memcmp(data_, kArchiveMagic, sizeof(kArchiveMagic)) != 0 || GetNumber(data_ + 8, 4) != kArchiveVersion)
+	{
+		return false;
+	}
+	uint64_t game_count = GetNumber(data_ + 16, 8);
+	uint64_t index_offset = GetNumber(data_ + 24, 8);
+	if (index_offset < kArchiveHeaderSize || index_offset > file_.GetSize() || (file_.GetSize() - index_offset) / 8 < game_count)
+	{
+		return false;
+	}
+	has_hashes_ = (GetNumber(data_ + 12, 4) & kArchiveHasHashes) != 0;
+	index_ = data_ + index_offset;
+	game_count_ = game_count;
+	return true;
+}
+
+/**
+ * Finds a game through the index, in constant time.
+ *
+ * @param number: The game's position in the archive, starting from 0
+ * @param game: Filled in with a view of the game
+ * @return: True if the game was found, false if there is no such game or its record is cut short.
+ */
+bool GameArchive::GetGame(uint64_t number, ArchivedGame& game) const
+{
+	if (number >= game_count_)
+	{
+		return false;
+	}
+	uint64_t offset = GetNumber(index_ + 8 * number, 8);
+	uint64_t limit = index_ - data_;
+	if (offset + 4 > limit)
+	{
+		return false;
+	}
+	const unsigned char* record = data_ + offset;
+	game.ply_count = static_cast<int>(GetNumber(record, 2));
+	game.result = kResults[record[2] & 3];
+	uint64_t size = 4;
+	game.fen = nullptr;
+	game.fen_length = 0;
+	if (record[3] & 1)
+	{
+		if (offset + 5 > limit || offset + 5 + record[4] > limit)
+		{
+			return false;
+		}
+		game.fen = reinterpret_cast<const char*>(record + 5);
+		game.fen_length = record[4];
+		size += 1 + record[4];
+	}
+	game.moves = record + size;
+	size += 2 * static_cast<uint64_t>(game.ply_count);
+	game.hashes = has_hashes_ ? record + size : nullptr;
+	size += has_hashes_ ? 8 * static_cast<uint64_t>(game.ply_count + 1) : 0;
+	return offset + size <= limit;
+}
+
+/**
+ * Sets up a board at some point of a game, checking that every move on the way is legal.
+ *
+ * @param number: The game's position in the archive, starting from 0
+ * @param chess_board: The board to set up. Its history holds the moves played.
+ * @param plies: The number of moves to play, or -1 for the whole game
+ * @return: True if the position was reached, false if the game is missing or holds an illegal move.
+ */
+bool GameArchive::Replay(uint64_t number, ChessBoard& chess_board, int plies) const
+{
+	ArchivedGame game;
+	if (!GetGame(number, game))
+	{
+		return false;
+	}
+	chess_board.Reset();
+	if (game.fen != nullptr)
+	{
+		char fen[256];
+		std::memcpy(fen, game.fen, game.fen_length);
+		fen[game.fen_length] = '\0';
+		if (!chess_board.FromFEN(fen))
+		{
+			return false;
+		}
+	}
+	int end = plies >= 0 && plies < game.ply_count ? plies : game.ply_count;
+	for (int ply = 0; ply < end; ply++)
+	{
+		Move move = game.GetMove(ply);
+		MoveList move_list;
+		GenerateLegalMoves(chess_board, move_list);
+		bool legal = false;
+		for (Move legal_move : move_list)
+		{
+			legal = legal || legal_move == move;
+		}
+		if (!legal)
+		{
+			return false;
+		}
+		chess_board.MakeMove(move);
+	}
+	return true;
+}
+
+/**
+ * Copies a game out of the archive so that it can be written as PGN. The archive does not keep tags,
+ * so only the Result tag is filled in.
+ *
+ * @param number: The game's position in the archive, starting from 0
+ * @param game: Filled in with the game
+ * @return: True if the game was found, false otherwise.
+ */
+bool GameArchive::ToPgn(uint64_t number, PgnGame& game) const
+{
+	ArchivedGame archived_game;
+	if (!GetGame(number, archived_game))
+	{
+		return false;
+	}
+	game.Clear();
+	if (archived_game.fen != nullptr)
+	{
+		game.fen.assign(archived_game.fen, archived_game.fen_length);
+	}
+	game.result = archived_game.result;
+	game.tags.emplace_back("Result", game.result);
+	if (!game.fen.empty())
+	{
+		game.tags.emplace_back("SetUp", "1");
+		game.tags.emplace_back("FEN", game.fen);
+	}
+	for (int ply = 0; ply < archived_game.ply_count; ply++)
+	{
+		game.moves.push_back(archived_game.GetMove(ply));
+	}
+	return true;
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include "ChessBoard.h"
+#include "MappedFile.h"
+#include "Pgn.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+using std::string;
+#include <vector>
+using std::vector;
+
+/**
+ * A compact binary file of games. All numbers are little-endian.
+ *
+ *   Header (32 bytes): "CHSGAME1", version (4 bytes), flags (4 bytes, bit 0 set if positions are hashed),
+ *                      game count (8 bytes), offset of the index (8 bytes)
+ *   Each game:         ply count (2 bytes), result (1 byte), flags (1 byte, bit 0 set if a FEN follows),
+ *                      [FEN length (1 byte), FEN], moves (2 bytes each, as Move::GetData),
+ *                      [the hash of every position, before each move and after the last (8 bytes each)]
+ *   Index:             the offset of each game (8 bytes each)
+ *
+ * A game of 80 plies takes 172 bytes with its index entry and no hashes, against 600 bytes or more of PGN.
+ */
+const char kArchiveMagic[8] = { 'C', 'H', 'S', 'G', 'A', 'M', 'E', '1' };
+const uint32_t kArchiveVersion = 1;
+const uint32_t kArchiveHasHashes = 1;
+const size_t kArchiveHeaderSize = 32;
+
+/**
+ * Writes games to an archive as they finish. The index is kept in memory and written by Close.
+ */
+class GameArchiveWriter
+{
+private:
+	std::ofstream file_;
+	vector<uint64_t> offsets_;
+	uint64_t position_ = 0;
+	bool store_hashes_ = false;
+	// The bytes of the game being written, reused from game to game.
+	vector<unsigned char> record_;
+
+public:
+	GameArchiveWriter() = default;
+	~GameArchiveWriter() { Close(); }
+
+	bool Open(const string& path, bool store_hashes);
+	bool WriteGame(const ChessBoard& chess_board, const string& result, const string& start_fen = "");
+	bool WriteGame(const PgnGame& game);
+	bool Close();
+};
+
+/**
+ * A view of one game inside a mapped archive. Nothing is copied; the view is valid while the archive is open.
+ */
+struct ArchivedGame
+{
+	int ply_count = 0;
+	// "1-0", "0-1", "1/2-1/2" or "*".
+	const char* result = "*";
+	// The starting position in FEN, not null terminated, or nullptr for the normal start position.
+	const char* fen = nullptr;
+	int fen_length = 0;
+	const unsigned char* moves = nullptr;
+	// nullptr if the archive does not store hashes.
+	const unsigned char* hashes = nullptr;
+
+	Move GetMove(int ply) const { return Move(static_cast<uint16_t>(moves[2 * ply] | moves[2 * ply + 1] << 8)); }
+	uint64_t GetHash(int ply) const;
+};
+
+/**
+ * Reads games from an archive mapped into memory. Any game can be found in constant time through the index.
+ */
+class GameArchive
+{
+private:
+	MappedFile file_;
+	const unsigned char* data_ = nullptr;
+	uint64_t game_count_ = 0;
+	const unsigned char* index_ = nullptr;
+	bool has_hashes_ = false;
+
+public:
+	bool Open(const string& path);
+
+	uint64_t GetGameCount() const { return game_count_; }
+	bool GetHasHashes() const { return has_hashes_; }
+	bool GetGame(uint64_t number, ArchivedGame& game) const;
+	bool Replay(uint64_t number, ChessBoard& chess_board, int plies = -1) const;
+	bool ToPgn(uint64_t number, PgnGame& game) const;
+};
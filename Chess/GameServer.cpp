@@ -0,0 +1,221 @@
+#include "GameServer.h"
+
+#include <sstream>
+
+/**
+ * Takes a free session, growing the pool by a block if none is left. The session starts at the normal
+ * start position with no watchers.
+ *
+ * @return: The new session's id.
+ */
+uint64_t SessionPool::Create()
+{
+	if (free_slots_.empty())
+	{
+		blocks_.emplace_back(new Session[kSessionBlockSize]);
+		for (int i = kSessionBlockSize - 1; i >= 0; i--)
+		{
+			free_slots_.push_back(slot_count_ + i);
+		}
+		slot_count_ += kSessionBlockSize;
+	}
+	uint32_t slot = free_slots_.back();
+	free_slots_.pop_back();
+	Session& session = blocks_[slot / kSessionBlockSize][slot % kSessionBlockSize];
+	session.in_use = true;
+	session.generation++;
+	session.watchers.fill(-1);
+	session.board.Reset();
+	active_count_++;
+	return static_cast<uint64_t>(session.generation) << 32 | slot;
+}
+
+/**
+ * @param id: A session id from Create
+ * @return: The session, or nullptr if the id is unknown or its game has been closed.
+ */
+Session* SessionPool::Find(uint64_t id)
+{
+	uint32_t slot = static_cast<uint32_t>(id);
+	if (slot >= slot_count_)
+	{
+		return nullptr;
+	}
+	Session& session = blocks_[slot / kSessionBlockSize][slot % kSessionBlockSize];
+	return session.in_use && session.generation == static_cast<uint32_t>(id >> 32) ? &session : nullptr;
+}
+
+/**
+ * Returns a session to the pool. The board's move history is freed, so an idle slot stays small.
+ *
+ * @param id: A session id from Create
+ * @return: True if the session was released, false if the id is unknown.
+ */
+bool SessionPool::Release(uint64_t id)
+{
+	Session* session = Find(id);
+	if (session == nullptr)
+	{
+		return false;
+	}
+	session->in_use = false;
+	session->board = ChessBoard();
+	free_slots_.push_back(static_cast<uint32_t>(id));
+	active_count_--;
+	return true;
+}
+
+/**
+ * Describes a game: its position, the last move and whether it is over.
+ *
+ * @param id: The session id
+ * @param session: The session
+ * @return: The state line, ending in a newline.
+ */
+string GameServer::FormatState(uint64_t id, const Session& session) const
+{
+	const ChessBoard& board = session.board;
+	MoveList move_list;
+	GenerateLegalMoves(board, move_list);
+	const char* status = "ongoing";
+	if (move_list.Size() == 0)
+	{
+		status = IsInCheck(board) ? "checkmate" : "stalemate";
+	}
+	else if (board.GetHalfmoveClock() >= 100)
+	{
+		status = "draw";
+	}
+
+	char fen[kMaxFENLength];
+	board.ToFEN(fen);
+	std::ostringstream out;
+	out << "state " << id << ' ' << fen << ' ';
+	if (board.GetHistory().empty())
+	{
+		out << '-';
+	}
+	else
+	{
+		out << board.GetHistory().back().move;
+	}
+	out << ' ' << status << '\n';
+	return out.str();
+}
+
+/**
+ * Sends a message to every client watching a game.
+ *
+ * @return: None
+ */
+void GameServer::Broadcast(const Session& session, const string& message)
+{
+	for (int watcher : session.watchers)
+	{
+		if (watcher >= 0)
+		{
+			send_(watcher, message);
+		}
+	}
+}
+
+/**
+ * Answers one line of the protocol described in GameServer.h.
+ *
+ * @param client: The client that sent the line
+ * @param line: The line, without its newline
+ * @return: None
+ */
+void GameServer::HandleLine(int client, const string& line)
+{
+	std::istringstream command(line);
+	string token;
+	command >> token;
+	if (token == "new")
+	{
+		uint64_t id = sessions_.Create();
+		Session* session = sessions_.Find(id);
+		string fen;
+		std::getline(command >> std::ws, fen);
+		if (!fen.empty() && !session->board.FromFEN(fen.c_str()))
+		{
+			sessions_.Release(id);
+			send_(client, "error - could not read the position\n");
+			return;
+		}
+		session->watchers[0] = client;
+		send_(client, "game " + std::to_string(id) + "\n");
+		return;
+	}
+	if (token == "stats")
+	{
+		send_(client, "stats " + std::to_string(sessions_.GetActiveCount()) + "\n");
+		return;
+	}
+
+	uint64_t id = 0;
+	command >> id;
+	Session* session = sessions_.Find(id);
+	if (session == nullptr)
+	{
+		send_(client, "error " + std::to_string(id) + " no such game\n");
+		return;
+	}
+	if (token == "watch")
+	{
+		bool watching = false;
+		for (int& watcher : session->watchers)
+		{
+			if (!watching && (watcher == -1 || watcher == client))
+			{
+				watcher = client;
+				watching = true;
+			}
+		}
+		send_(client, watching ? FormatState(id, *session) : "error " + std::to_string(id) + " too many watchers\n");
+	}
+	else if (token == "move")
+	{
+		command >> token;
+		Move move = ParseMove(session->board, token.c_str());
+		if (move == Move())
+		{
+			send_(client, "error " + std::to_string(id) + " illegal move " + token + "\n");
+			return;
+		}
+		session->board.MakeMove(move);
+		Broadcast(*session, FormatState(id, *session));
+	}
+	else if (token == "state")
+	{
+		send_(client, FormatState(id, *session));
+	}
+	else if (token == "close")
+	{
+		Broadcast(*session, "closed " + std::to_string(id) + "\n");
+		sessions_.Release(id);
+	}
+	else
+	{
+		send_(client, "error " + std::to_string(id) + " unknown command " + token + "\n");
+	}
+}
+
+/**
+ * Forgets a client that has disconnected, so that no more updates are sent to it. Its games stay open
+ * for the other players.
+ *
+ * @param client: The client
+ * @return: None
+ */
+void GameServer::RemoveClient(int client)
+{
+	// Disconnects are rare next to moves, so a scan of the pool is cheaper than keeping a list per client.
+	sessions_.ForEachSession([client](Session& session)
+	{
+		for (int& watcher : session.watchers)
+		{
+			watcher = watcher == client ? -1 : watcher;
+		}
+	});
+}
@@ -0,0 +1,95 @@
+#pragma once
+#include "ChessBoard.h"
+#include "MoveGen.h"
+
+#include <array>
+using std::array;
+#include <cstdint>
+#include <functional>
+#include <memory>
+using std::unique_ptr;
+#include <string>
+using std::string;
+#include <vector>
+using std::vector;
+
+// A session can push its updates to this many clients, which covers two players and a few spectators.
+const int kMaxWatchers = 4;
+// Sessions are allocated in blocks of this many, so the pool grows without moving the sessions it holds.
+const int kSessionBlockSize = 1024;
+
+/**
+ * One game hosted by the server.
+ */
+struct Session
+{
+	ChessBoard board;
+	// The clients that receive this game's updates, or -1 for an empty slot.
+	array<int, kMaxWatchers> watchers;
+	// Bumped every time the slot is reused, so that an old game's id does not reach the new game.
+	uint32_t generation = 0;
+	bool in_use = false;
+};
+
+/**
+ * A pool of sessions. Free slots are kept on a list and reused before the pool grows, and sessions live in
+ * fixed blocks, so a game never moves in memory and a finished game's slot costs nothing to recycle.
+ */
+class SessionPool
+{
+private:
+	vector<unique_ptr<Session[]>> blocks_;
+	vector<uint32_t> free_slots_;
+	uint32_t slot_count_ = 0;
+	size_t active_count_ = 0;
+
+public:
+	uint64_t Create();
+	Session* Find(uint64_t id);
+	bool Release(uint64_t id);
+	size_t GetActiveCount() const { return active_count_; }
+
+	template <typename Function>
+	void ForEachSession(Function function)
+	{
+		for (uint32_t slot = 0; slot < slot_count_; slot++)
+		{
+			Session& session = blocks_[slot / kSessionBlockSize][slot % kSessionBlockSize];
+			if (session.in_use)
+			{
+				function(session);
+			}
+		}
+	}
+};
+
+/**
+ * The rules side of the game server: it keeps the sessions and answers each line of the protocol. It knows
+ * nothing about sockets; replies and updates go out through the send function it is given. Clients are
+ * identified by any number the transport chooses, such as a socket descriptor.
+ *
+ * The protocol is one command per line, answered by one or more lines:
+ *   new [fen]             -> game <id>, and the sender watches the new game
+ *   watch <id>            -> state <id> ...
+ *   move <id> <move>      -> state <id> ... to every watcher, or error <id> <reason> to the sender
+ *   state <id>            -> state <id> <fen> <last move or -> <ongoing|checkmate|stalemate|draw>
+ *   close <id>            -> closed <id> to every watcher
+ *   stats                 -> stats <active sessions>
+ * Moves are in coordinate notation, such as e2e4 or e7e8q.
+ */
+class GameServer
+{
+private:
+	SessionPool sessions_;
+	std::function<void(int client, const string& message)> send_;
+
+	string FormatState(uint64_t id, const Session& session) const;
+	void Broadcast(const Session& session, const string& message);
+
+public:
+	explicit GameServer(std::function<void(int client, const string& message)> send) : send_(std::move(send)) {}
+
+	void HandleLine(int client, const string& line);
+	void RemoveClient(int client);
+	size_t GetActiveSessions() const { return sessions_.GetActiveCount(); }
+};
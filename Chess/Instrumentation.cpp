@@ -0,0 +1,470 @@
+#include "Instrumentation.h"
+
+#ifdef CHESS_INSTRUMENTATION
+
+#include <algorithm>
+#include <array>
+using std::array;
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+using std::unique_ptr;
+#include <mutex>
+#include <vector>
+using std::vector;
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define CHESS_HAS_TSC
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define CHESS_HAS_TSC
+#endif
+
+// Indexed by Probe.
+static const char* const kProbeNames[kProbeCount] = {
+	"CheckValidMove", "CheckCollision", "UpdateInCheck", "KingHasValidMoves", "MovePiece", "SearchNode", "QuiescenceNode"
+};
+
+/**
+ * One probe's counters on one thread. Only that thread writes them, so relaxed atomics are enough to let
+ * them be read from another thread, and they compile to plain loads and stores.
+ */
+struct ProbeCounters
+{
+	std::atomic<uint64_t> calls{ 0 };
+	std::atomic<uint64_t> total_cycles{ 0 };
+	std::atomic<uint64_t> min_cycles{ UINT64_MAX };
+	std::atomic<uint64_t> max_cycles{ 0 };
+	array<std::atomic<uint64_t>, kHistogramBuckets> histogram{};
+};
+
+/**
+ * One timed call, for the Chrome trace.
+ */
+struct TraceEvent
+{
+	Probe probe;
+	uint64_t start_cycles;
+	uint64_t cycles;
+};
+
+/**
+ * A traced call of a thread that has ended.
+ */
+struct RetiredTraceEvent
+{
+	int thread_index;
+	TraceEvent event;
+};
+
+/**
+ * Everything one thread has recorded, for as long as the thread runs.
+ */
+struct ThreadCounters
+{
+	int thread_index = 0;
+	array<ProbeCounters, kProbeCount> probes;
+	// Allocated only when tracing.
+	unique_ptr<TraceEvent[]> trace;
+	std::atomic<size_t> trace_size{ 0 };
+};
+
+/**
+ * The counters of every running thread that has recorded anything, and the totals of the threads that have
+ * ended. Written out when the program exits.
+ */
+struct Registry
+{
+	std::mutex mutex;
+	vector<unique_ptr<ThreadCounters>> threads;
+	int next_thread_index = 0;
+	// The counters of every thread that has ended, added together under the mutex, and the calls they traced.
+	array<ProbeCounters, kProbeCount> retired;
+	int retired_count = 0;
+	vector<RetiredTraceEvent> retired_trace;
+	bool tracing = std::getenv("CHESS_TRACE") != nullptr;
+	// When the registry was created, by both clocks, which gives the number of cycles in a microsecond.
+	uint64_t start_cycles = ReadCycles();
+	std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+
+	~Registry();
+};
+
+static Registry& GetRegistry()
+{
+	static Registry registry;
+	return registry;
+}
+
+/**
+ * Adds to a counter that only the calling thread writes.
+ *
+ * @param counter: The counter
+ * @param amount: What to add
+ * @return: None
+ */
+static void Increase(std::atomic<uint64_t>& counter, uint64_t amount)
+{
+	counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+/**
+ * Adds one set of a probe's counters into another.
+ *
+ * @param total: The counters added to, which only the calling thread writes
+ * @param counters: The counters to add
+ * @return: None
+ */
+static void AddCounters(ProbeCounters& total, const ProbeCounters& counters)
+{
+	Increase(total.calls, counters.calls.load(std::memory_order_relaxed));
+	Increase(total.total_cycles, counters.total_cycles.load(std::memory_order_relaxed));
+	total.min_cycles.store(std::min(total.min_cycles.load(std::memory_order_relaxed), counters.min_cycles.load(std::memory_order_relaxed)), std::memory_order_relaxed);
+	total.max_cycles.store(std::max(total.max_cycles.load(std::memory_order_relaxed), counters.max_cycles.load(std::memory_order_relaxed)), std::memory_order_relaxed);
+	for (int bucket = 0; bucket < kHistogramBuckets; bucket++)
+	{
+		Increase(total.histogram[bucket], counters.histogram[bucket].load(std::memory_order_relaxed));
+	}
+}
+
+// The calling thread's counters, or nullptr until it records something. Kept apart from the owner below,
+// which needs a guard on every access because it has a destructor.
+static thread_local ThreadCounters* tls_thread_counters = nullptr;
+
+/**
+ * Owns a thread's counters, and when the thread ends adds them to the registry's retired totals and frees
+ * them, so that programs which start many threads do not keep the counters and trace buffer of each one.
+ */
+class ThreadCountersOwner
+{
+private:
+	ThreadCounters* counters_ = nullptr;
+
+public:
+	ThreadCountersOwner() = default;
+	ThreadCountersOwner(const ThreadCountersOwner&) = delete;
+	ThreadCountersOwner& operator=(const ThreadCountersOwner&) = delete;
+	~ThreadCountersOwner();
+
+	ThreadCounters& Get();
+};
+
+/**
+ * @return: The thread's counters, which are created the first time the thread records anything.
+ */
+ThreadCounters& ThreadCountersOwner::Get()
+{
+	if (counters_ == nullptr)
+	{
+		Registry& registry = GetRegistry();
+		unique_ptr<ThreadCounters> counters(new ThreadCounters());
+		if (registry.tracing)
+		{
+			counters->trace.reset(new TraceEvent[kMaxTraceEvents]);
+		}
+		std::lock_guard<std::mutex> lock(registry.mutex);
+		counters->thread_index = registry.next_thread_index++;
+		counters_ = counters.get();
+		registry.threads.push_back(std::move(counters));
+	}
+	return *counters_;
+}
+
+/**
+ * Retires the thread's counters. The calls it traced are kept, up to kMaxRetiredTraceEvents over all the
+ * threads that have ended.
+ */
+ThreadCountersOwner::~ThreadCountersOwner()
+{
+	if (counters_ == nullptr)
+	{
+		return;
+	}
+	Registry& registry = GetRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+	for (int probe = 0; probe < kProbeCount; probe++)
+	{
+		AddCounters(registry.retired[probe], counters_->probes[probe]);
+	}
+	registry.retired_count++;
+	size_t trace_size = counters_->trace_size.load(std::memory_order_relaxed);
+	for (size_t i = 0; i < trace_size && registry.retired_trace.size() < static_cast<size_t>(kMaxRetiredTraceEvents); i++)
+	{
+		registry.retired_trace.push_back(RetiredTraceEvent{ counters_->thread_index, counters_->trace[i] });
+	}
+	auto found = std::find_if(registry.threads.begin(), registry.threads.end(),
+		[this](const unique_ptr<ThreadCounters>& thread) { return thread.get() == counters_; });
+	registry.threads.erase(found);
+	counters_ = nullptr;
+	tls_thread_counters = nullptr;
+}
+
+/**
+ * @return: The calling thread's counters.
+ */
+static ThreadCounters& GetThreadCounters()
+{
+	if (tls_thread_counters == nullptr)
+	{
+		static thread_local ThreadCountersOwner owner;
+		tls_thread_counters = &owner.Get();
+	}
+	return *tls_thread_counters;
+}
+
+/**
+ * @return: The processor's time stamp counter on x86, or a count of nanoseconds elsewhere.
+ */
+uint64_t ReadCycles()
+{
+#ifdef CHESS_HAS_TSC
+	return __rdtsc();
+#else
+	return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+/**
+ * Records one timed call on the calling thread.
+ *
+ * @param probe: What was called
+ * @param start_cycles: ReadCycles when the call started
+ * @param end_cycles: ReadCycles when it returned
+ * @return: None
+ */
+void RecordCall(Probe probe, uint64_t start_cycles, uint64_t end_cycles)
+{
+	ThreadCounters& counters = GetThreadCounters();
+	ProbeCounters& probe_counters = counters.probes[static_cast<int>(probe)];
+	// The time stamp counter can step backwards when a thread moves between processors.
+	uint64_t cycles = end_cycles > start_cycles ? end_cycles - start_cycles : 0;
+	Increase(probe_counters.calls, 1);
+	Increase(probe_counters.total_cycles, cycles);
+	if (cycles < probe_counters.min_cycles.load(std::memory_order_relaxed))
+	{
+		probe_counters.min_cycles.store(cycles, std::memory_order_relaxed);
+	}
+	if (cycles > probe_counters.max_cycles.load(std::memory_order_relaxed))
+	{
+		probe_counters.max_cycles.store(cycles, std::memory_order_relaxed);
+	}
+	int bucket = 0;
+	while (bucket < kHistogramBuckets - 1 && (cycles >> (bucket + 1)) != 0)
+	{
+		bucket++;
+	}
+	Increase(probe_counters.histogram[bucket], 1);
+
+	size_t trace_size = counters.trace_size.load(std::memory_order_relaxed);
+	if (counters.trace && trace_size < static_cast<size_t>(kMaxTraceEvents))
+	{
+		counters.trace[trace_size] = TraceEvent{ probe, start_cycles, cycles };
+		// The event is written before the size that makes it visible.
+		counters.trace_size.store(trace_size + 1, std::memory_order_release);
+	}
+}
+
+/**
+ * Counts one call on the calling thread, without timing it.
+ *
+ * @param probe: What was called
+ * @return: None
+ */
+void CountCall(Probe probe)
+{
+	Increase(GetThreadCounters().probes[static_cast<int>(probe)].calls, 1);
+}
+
+/**
+ * @param registry: The registry
+ * @return: How many cycles there are in a microsecond, measured since the registry was created.
+ */
+static double CyclesPerMicrosecond(const Registry& registry)
+{
+#ifdef CHESS_HAS_TSC
+	double microseconds = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - registry.start_time).count();
+	return microseconds > 0 ? (ReadCycles() - registry.start_cycles) / microseconds : 1.0;
+#else
+	(void)registry;
+	return 1000.0;
+#endif
+}
+
+/**
+ * Writes the counters of every thread, merged, and how many calls each running thread made.
+ *
+ *   { "cycles_per_microsecond": ..., "threads": ..., "ended_threads": ..., "probes": { "<name>": { "calls",
+ *     "total_cycles", "mean_cycles", "min_cycles", "max_cycles", "calls_per_thread": [...], "ended_thread_calls",
+ *     "histogram": [ { "min_cycles": 2^n, "calls": ... }, ... ] }, ... } }
+ *
+ * "threads" counts every thread, running or ended, and "calls_per_thread" lists the running ones. Counted
+ * probes have no cycle counts or histogram. Empty histogram buckets are left out.
+ *
+ * @param registry: The registry
+ * @param path: The file to write
+ * @return: True if the file was written, false otherwise.
+ */
+static bool WriteJson(Registry& registry, const string& path)
+{
+	std::ofstream out(path);
+	if (!out)
+	{
+		return false;
+	}
+	std::lock_guard<std::mutex> lock(registry.mutex);
+	out << "{\n  \"cycles_per_microsecond\": " << CyclesPerMicrosecond(registry)
+		<< ",\n  \"threads\": " << registry.threads.size() + registry.retired_count << ",\n  \"ended_threads\": " << registry.retired_count
+		<< ",\n  \"probes\": {";
+	for (int probe = 0; probe < kProbeCount; probe++)
+	{
+		ProbeCounters merged;
+		AddCounters(merged, registry.retired[probe]);
+		for (const auto& thread : registry.threads)
+		{
+			AddCounters(merged, thread->probes[probe]);
+		}
+		uint64_t calls = merged.calls.load(std::memory_order_relaxed);
+		uint64_t total_cycles = merged.total_cycles.load(std::memory_order_relaxed);
+		uint64_t min_cycles = merged.min_cycles.load(std::memory_order_relaxed);
+		uint64_t max_cycles = merged.max_cycles.load(std::memory_order_relaxed);
+
+		out << (probe == 0 ? "\n" : ",\n") << "    \"" << kProbeNames[probe] << "\": { \"calls\": " << calls;
+		if (total_cycles > 0 || min_cycles != UINT64_MAX)
+		{
+			out << ", \"total_cycles\": " << total_cycles << ", \"mean_cycles\": " << static_cast<double>(total_cycles) / calls
+				<< ", \"min_cycles\": " << min_cycles << ", \"max_cycles\": " << max_cycles;
+		}
+		out << ", \"calls_per_thread\": [";
+		for (size_t i = 0; i < registry.threads.size(); i++)
+		{
+			out << (i == 0 ? "" : ", ") << registry.threads[i]->probes[probe].calls.load(std::memory_order_relaxed);
+		}
+		out << "], \"ended_thread_calls\": " << registry.retired[probe].calls.load(std::memory_order_relaxed);
+		if (total_cycles > 0 || min_cycles != UINT64_MAX)
+		{
+			out << ", \"histogram\": [";
+			bool first = true;
+			for (int bucket = 0; bucket < kHistogramBuckets; bucket++)
+			{
+				uint64_t bucket_calls = merged.histogram[bucket].load(std::memory_order_relaxed);
+				if (bucket_calls != 0)
+				{
+					out << (first ? "" : ", ") << "{ \"min_cycles\": " << (bucket == 0 ? 0 : uint64_t(1) << bucket) << ", \"calls\": " << bucket_calls << " }";
+					first = false;
+				}
+			}
+			out << "]";
+		}
+		out << " }";
+	}
+	out << "\n  }\n}\n";
+	return static_cast<bool>(out);
+}
+
+/**
+ * Writes one traced call as a complete ("X") event.
+ *
+ * @param out: Where to write it
+ * @param registry: The registry
+ * @param cycles_per_microsecond: What CyclesPerMicrosecond returned
+ * @param thread_index: The thread that made the call
+ * @param event: The call
+ * @return: None
+ */
+static void WriteTraceEvent(std::ofstream& out, const Registry& registry, double cycles_per_microsecond, int thread_index, const TraceEvent& event)
+{
+	double start = event.start_cycles > registry.start_cycles ? (event.start_cycles - registry.start_cycles) / cycles_per_microsecond : 0.0;
+	out << ",\n{\"name\": \"" << kProbeNames[static_cast<int>(event.probe)] << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": "
+		<< thread_index << ", \"ts\": " << start << ", \"dur\": " << event.cycles / cycles_per_microsecond << "}";
+}
+
+/**
+ * Writes the traced calls of every thread as complete ("X") events in the Chrome trace event format,
+ * with times in microseconds from when the first probe fired. The calls of threads that have ended come first.
+ *
+ * @param registry: The registry
+ * @param path: The file to write
+ * @return: True if the file was written, false otherwise.
+ */
+static bool WriteTrace(Registry& registry, const string& path)
+{
+	std::ofstream out(path);
+	if (!out)
+	{
+		return false;
+	}
+	std::lock_guard<std::mutex> lock(registry.mutex);
+	double cycles_per_microsecond = CyclesPerMicrosecond(registry);
+	out << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [";
+	auto write_thread_name = [&out](int thread_index, bool first)
+	{
+		out << (first ? "\n" : ",\n") << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << thread_index
+			<< ", \"args\": {\"name\": \"Thread " << thread_index << "\"}}";
+	};
+	bool first = true;
+	for (size_t i = 0; i < registry.retired_trace.size(); i++)
+	{
+		const RetiredTraceEvent& retired = registry.retired_trace[i];
+		if (i == 0 || registry.retired_trace[i - 1].thread_index != retired.thread_index)
+		{
+			write_thread_name(retired.thread_index, first);
+			first = false;
+		}
+		WriteTraceEvent(out, registry, cycles_per_microsecond, retired.thread_index, retired.event);
+	}
+	for (const auto& thread : registry.threads)
+	{
+		write_thread_name(thread->thread_index, first);
+		first = false;
+		size_t trace_size = thread->trace_size.load(std::memory_order_acquire);
+		for (size_t i = 0; i < trace_size; i++)
+		{
+			WriteTraceEvent(out, registry, cycles_per_microsecond, thread->thread_index, thread->trace[i]);
+		}
+	}
+	out << "\n]}\n";
+	return static_cast<bool>(out);
+}
+
+/**
+ * Writes the merged counters of every thread as JSON. Threads may still be recording while this runs.
+ *
+ * @param path: The file to write
+ * @return: True if the file was written, false otherwise.
+ */
+bool WriteInstrumentationJson(const string& path)
+{
+	return WriteJson(GetRegistry(), path);
+}
+
+/**
+ * Writes the calls recorded for the trace (see CHESS_TRACE) in the Chrome trace format.
+ *
+ * @param path: The file to write
+ * @return: True if the file was written, false otherwise.
+ */
+bool WriteChromeTrace(const string& path)
+{
+	return WriteTrace(GetRegistry(), path);
+}
+
+/**
+ * Writes the files named by the environment when the program exits.
+ */
+Registry::~Registry()
+{
+	if (const char* json_path = std::getenv("CHESS_INSTRUMENTATION_JSON"))
+	{
+		WriteJson(*this, json_path);
+	}
+	if (const char* trace_path = std::getenv("CHESS_TRACE"))
+	{
+		WriteTrace(*this, trace_path);
+	}
+}
+
+#endif
@@ -0,0 +1,69 @@
+#pragma once
+
+/**
+ * Counters and timers for the hot paths, compiled in only when CHESS_INSTRUMENTATION is defined (configure
+ * with -DCHESS_INSTRUMENTATION=ON). Otherwise the probe macros expand to nothing and the code is exactly
+ * the same as a build without them.
+ *
+ * A timed probe counts the calls of the function it is placed in and how many cycles each took, in a
+ * histogram of powers of two. A counted probe only counts, which suits the search nodes: a node's time
+ * includes all of the nodes below it. Each thread records into its own counters, so probes never contend,
+ * and the counters of every thread are merged when they are written out. When a thread ends, its counters
+ * are added to a total for ended threads and freed.
+ *
+ * When a program instrumented this way exits, it writes the merged counters as JSON to the file named by
+ * the CHESS_INSTRUMENTATION_JSON environment variable, if set. If CHESS_TRACE names a file, the first
+ * kMaxTraceEvents timed calls of each thread are also recorded and written there in the Chrome trace
+ * format, which chrome://tracing and Perfetto can open. The calls of threads that have ended are kept up to
+ * kMaxRetiredTraceEvents in all.
+ *
+ * Cycles are read from the processor's time stamp counter on x86, and are nanoseconds elsewhere.
+ */
+#ifdef CHESS_INSTRUMENTATION
+
+#include <cstdint>
+#include <string>
+using std::string;
+
+enum class Probe { CheckValidMove, CheckCollision, UpdateInCheck, KingHasValidMoves, MovePiece, SearchNode, QuiescenceNode, Count };
+
+const int kProbeCount = static_cast<int>(Probe::Count);
+// One histogram bucket per power of two: bucket n counts the calls that took 2^n to 2^(n+1) - 1 cycles.
+const int kHistogramBuckets = 64;
+const int kMaxTraceEvents = 1 << 16;
+const int kMaxRetiredTraceEvents = 1 << 20;
+
+uint64_t ReadCycles();
+void RecordCall(Probe probe, uint64_t start_cycles, uint64_t end_cycles);
+void CountCall(Probe probe);
+
+bool WriteInstrumentationJson(const string& path);
+bool WriteChromeTrace(const string& path);
+
+/**
+ * Times the rest of the scope it is declared in.
+ */
+class ScopedProbe
+{
+private:
+	Probe probe_;
+	uint64_t start_;
+
+public:
+	explicit ScopedProbe(Probe probe) : probe_(probe), start_(ReadCycles()) {}
+	ScopedProbe(const ScopedProbe&) = delete;
+	ScopedProbe& operator=(const ScopedProbe&) = delete;
+	~ScopedProbe() { RecordCall(probe_, start_, ReadCycles()); }
+};
+
+#define CHESS_PROBE_NAME(line) chess_probe_##line
+#define CHESS_PROBE_LINE(name, line) ScopedProbe CHESS_PROBE_NAME(line)(Probe::name)
+#define CHESS_TIMED_PROBE(name) CHESS_PROBE_LINE(name, __LINE__)
+#define CHESS_COUNTED_PROBE(name) CountCall(Probe::name)
+
+#else
+
+#define CHESS_TIMED_PROBE(name)
+#define CHESS_COUNTED_PROBE(name)
+
+#endif
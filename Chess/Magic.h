@@ -0,0 +1,77 @@
+#pragma once
+#include "Bitboard.h"
+
+#include <array>
+using std::array;
+
+/**
+ * PEXT (from the BMI2 instruction set) gathers the occupancy bits under a mask into a dense index in one
+ * instruction. It is used whenever the compiler is allowed to emit it; otherwise the index is computed
+ * with a magic multiply, which works on any 64-bit processor.
+ */
+#if defined(__BMI2__) || (defined(_MSC_VER) && defined(__AVX2__))
+#define CHESS_USE_PEXT 1
+#include <immintrin.h>
+#endif
+
+/**
+ * The lookup data for one sliding piece on one square. Only the squares in the mask can block the piece
+ * (the edge squares never matter), so the blockers under the mask are turned into an index into a table
+ * holding the attacks for every possible arrangement of blockers.
+ */
+struct Magic
+{
+	Bitboard mask = kEmptyBitboard;
+	Bitboard magic = kEmptyBitboard;
+	const Bitboard* attacks = nullptr;
+	int shift = 0;
+};
+
+extern array<Magic, 64> rook_magics;
+extern array<Magic, 64> bishop_magics;
+
+/**
+ * @param entry: The lookup data for a piece and square
+ * @param occupied: Every occupied square on the board
+ * @return: The position in the entry's attack table that holds the attacks for this occupancy.
+ */
+inline unsigned MagicIndex(const Magic& entry, Bitboard occupied)
+{
+#ifdef CHESS_USE_PEXT
+	return static_cast<unsigned>(_pext_u64(occupied, entry.mask));
+#else
+	return static_cast<unsigned>(((occupied & entry.mask) * entry.magic) >> entry.shift);
+#endif
+}
+
+/**
+ * @param square: The square the rook is on
+ * @param occupied: Every occupied square on the board
+ * @return: The squares a rook on that square attacks, including the first blocker on each ray.
+ */
+inline Bitboard RookAttacks(int square, Bitboard occupied)
+{
+	const Magic& entry = rook_magics[square];
+	return entry.attacks[MagicIndex(entry, occupied)];
+}
+
+/**
+ * @param square: The square the bishop is on
+ * @param occupied: Every occupied square on the board
+ * @return: The squares a bishop on that square attacks, including the first blocker on each ray.
+ */
+inline Bitboard BishopAttacks(int square, Bitboard occupied)
+{
+	const Magic& entry = bishop_magics[square];
+	return entry.attacks[MagicIndex(entry, occupied)];
+}
+
+/**
+ * @param square: The square the queen is on
+ * @param occupied: Every occupied square on the board
+ * @return: The squares a queen on that square attacks.
+ */
+inline Bitboard QueenAttacks(int square, Bitboard occupied)
+{
+	return RookAttacks(square, occupied) | BishopAttacks(square, occupied);
+}
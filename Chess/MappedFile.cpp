@@ -0,0 +1,114 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+ * Maps a file into memory, replacing any file already mapped. An empty file maps to an empty view.
+ *
+ * @param path: The file to map
+ * @return: True if the file was mapped, false if it could not be opened or mapped.
+ */
+bool MappedFile::Open(const string& path)
+{
+	Close();
+#ifdef _WIN32
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size))
+	{
+		CloseHandle(file);
+		return false;
+	}
+	file_ = file;
+	if (size.QuadPart == 0)
+	{
+		return true;
+	}
+	mapping_ = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping_ == nullptr)
+	{
+		Close();
+		return false;
+	}
+	data_ = static_cast<const char*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+	if (data_ == nullptr)
+	{
+		Close();
+		return false;
+	}
+	size_ = static_cast<size_t>(size.QuadPart);
+	return true;
+#else
+	int file = open(path.c_str(), O_RDONLY);
+	if (file < 0)
+	{
+		return false;
+	}
+	struct stat status;
+	if (fstat(file, &status) != 0)
+	{
+		close(file);
+		return false;
+	}
+	if (status.st_size == 0)
+	{
+		close(file);
+		return true;
+	}
+	void* data = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+	// The mapping keeps the file open, so the descriptor is no longer needed.
+	close(file);
+	if (data == MAP_FAILED)
+	{
+		return false;
+	}
+	// The file is mostly read from front to back, so the kernel can read ahead aggressively.
+	madvise(data, static_cast<size_t>(status.st_size), MADV_SEQUENTIAL);
+	data_ = static_cast<const char*>(data);
+	size_ = static_cast<size_t>(status.st_size);
+	return true;
+#endif
+}
+
+/**
+ * Unmaps the file. Any pointers into it become invalid.
+ *
+ * @return: None
+ */
+void MappedFile::Close()
+{
+#ifdef _WIN32
+	if (data_ != nullptr)
+	{
+		UnmapViewOfFile(data_);
+	}
+	if (mapping_ != nullptr)
+	{
+		CloseHandle(mapping_);
+	}
+	if (file_ != nullptr)
+	{
+		CloseHandle(file_);
+	}
+	mapping_ = nullptr;
+	file_ = nullptr;
+#else
+	if (data_ != nullptr)
+	{
+		munmap(const_cast<char*>(data_), size_);
+	}
+#endif
+	data_ = nullptr;
+	size_ = 0;
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <cstddef>
+#include <string>
+using std::string;
+
+/**
+ * A read-only view of a whole file mapped into memory. The operating system pages the file in as it is
+ * read and can drop pages that are no longer needed, so archives far larger than memory can be scanned.
+ */
+class MappedFile
+{
+private:
+	const char* data_ = nullptr;
+	size_t size_ = 0;
+#ifdef _WIN32
+	void* file_ = nullptr;
+	void* mapping_ = nullptr;
+#endif
+
+public:
+	MappedFile() = default;
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+	~MappedFile() { Close(); }
+
+	bool Open(const string& path);
+	void Close();
+
+	const char* GetData() const { return data_; }
+	size_t GetSize() const { return size_; }
+	const char* begin() const { return data_; }
+	const char* end() const { return data_ + size_; }
+};
@@ -0,0 +1,34 @@
+#include "Move.h"
+
+/**
+ * This operator is used to print moves in coordinate notation, such as "e2e4" or "e7e8q".
+ * Files run from a to h across the columns, and ranks run from 8 at row 0 down to 1 at row 7.
+ *
+ * @param out: The ostream& that will be used for printing.
+ * @param move: The move to print
+ * @return: The ostream& that will be used for printing.
+ */
+ostream& operator<<(ostream& out, const Move& move)
+{
+	out << static_cast<char>('a' + move.GetStart() % 8) << static_cast<char>('8' - move.GetStart() / 8)
+		<< static_cast<char>('a' + move.GetEnd() % 8) << static_cast<char>('8' - move.GetEnd() / 8);
+	if (move.GetType() == MoveType::Promotion)
+	{
+		switch (move.GetPromotion())
+		{
+		case Piece::Queen:
+			out << 'q';
+			break;
+		case Piece::Rook:
+			out << 'r';
+			break;
+		case Piece::Bishop:
+			out << 'b';
+			break;
+		default:
+			out << 'n';
+			break;
+		}
+	}
+	return out;
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include "ChessPiece.h"
+
+#include <cstdint>
+
+enum class MoveType { Normal, Promotion, EnPassant, Castling };
+
+/**
+ * A move packed into 16 bits: the start square in bits 0-5, the end square in bits 6-11,
+ * the promotion piece in bits 12-13 and the move type in bits 14-15. Castling moves are stored
+ * as the king moving two squares towards the rook.
+ */
+class Move
+{
+private:
+	uint16_t data_ = 0;
+
+public:
+	Move() = default;
+	Move(int start, int end, MoveType type = MoveType::Normal, Piece promotion = Piece::Knight)
+		: data_(static_cast<uint16_t>(start | (end << 6) | ((static_cast<int>(promotion) - static_cast<int>(Piece::Knight)) << 12)
+			| (static_cast<int>(type) << 14))) {}
+	// Rebuilds a move from the 16 bits returned by GetData.
+	explicit Move(uint16_t data) : data_(data) {}
+
+	int GetStart() const { return data_ & 63; }
+	int GetEnd() const { return (data_ >> 6) & 63; }
+	MoveType GetType() const { return static_cast<MoveType>(data_ >> 14); }
+	Piece GetPromotion() const { return static_cast<Piece>(((data_ >> 12) & 3) + static_cast<int>(Piece::Knight)); }
+	uint16_t GetData() const { return data_; }
+
+	bool operator==(const Move& other) const { return data_ == other.data_; }
+	bool operator!=(const Move& other) const { return data_ != other.data_; }
+};
+
+ostream& operator<<(ostream& out, const Move& move);
@@ -0,0 +1,437 @@
+#include "MoveGen.h"
+
+/**
+ * Finds every piece, of either color, that attacks a square.
+ *
+ * @param chess_board: The board
+ * @param square: The square being attacked
+ * @param occupied: The occupied squares to use for sliding pieces. This is usually the board's own
+ * occupancy, but can be changed to ask what would be attacked after a piece moves away.
+ * @return: The squares of every piece attacking the square.
+ */
+Bitboard AttackersTo(const ChessBoard& chess_board, int square, Bitboard occupied)
+{
+	Bitboard queens = chess_board.GetPieces(Piece::Queen);
+	Bitboard rooks = chess_board.GetPieces(Piece::Rook) | queens;
+	Bitboard bishops = chess_board.GetPieces(Piece::Bishop) | queens;
+
+	// A white pawn attacks the square if a black pawn standing on the square would attack the white pawn, and vice versa.
+	return (PawnAttacks(Color::Black, square) & chess_board.GetPieces(Color::White, Piece::Pawn))
+		| (PawnAttacks(Color::White, square) & chess_board.GetPieces(Color::Black, Piece::Pawn))
+		| (KnightAttacks(square) & chess_board.GetPieces(Piece::Knight))
+		| (KingAttacks(square) & chess_board.GetPieces(Piece::King))
+		| (RookAttacks(square, occupied) & rooks)
+		| (BishopAttacks(square, occupied) & bishops);
+}
+
+/**
+ * Checks whether any piece of a color attacks a square.
+ *
+ * @param chess_board: The board
+ * @param square: The square being attacked
+ * @param attacker: The color of the attacking pieces
+ * @return: True if the square is attacked, false otherwise.
+ */
+bool IsSquareAttacked(const ChessBoard& chess_board, int square, Color attacker)
+{
+	return (AttackersTo(chess_board, square, chess_board.GetOccupied()) & chess_board.GetOccupancy(attacker)) != kEmptyBitboard;
+}
+
+/**
+ * @param chess_board: The board
+ * @return: True if the king of the side to move is attacked, false otherwise.
+ */
+bool IsInCheck(const ChessBoard& chess_board)
+{
+	Color us = chess_board.GetSideToMove();
+	Bitboard king = chess_board.GetPieces(us, Piece::King);
+	return king && IsSquareAttacked(chess_board, LowestSquare(king), GetOppositeColor(us));
+}
+
+/**
+ * Builds the attack map of one color: every square that at least one of its pieces attacks.
+ * Pawns count the squares they could capture on, not the squares they can move forward to.
+ *
+ * @param chess_board: The board
+ * @param attacker: The color of the attacking pieces
+ * @param occupied: The occupied squares to use for sliding pieces, as in AttackersTo
+ * @return: Every square attacked by the color.
+ */
+Bitboard AttackedSquares(const ChessBoard& chess_board, Color attacker, Bitboard occupied)
+{
+	Bitboard attacked = kEmptyBitboard;
+
+	Bitboard pawns = chess_board.GetPieces(attacker, Piece::Pawn);
+	while (pawns)
+	{
+		attacked |= PawnAttacks(attacker, PopLowestSquare(pawns));
+	}
+	Bitboard knights = chess_board.GetPieces(attacker, Piece::Knight);
+	while (knights)
+	{
+		attacked |= KnightAttacks(PopLowestSquare(knights));
+	}
+	Bitboard queens = chess_board.GetPieces(attacker, Piece::Queen);
+	Bitboard bishops = chess_board.GetPieces(attacker, Piece::Bishop) | queens;
+	while (bishops)
+	{
+		attacked |= BishopAttacks(PopLowestSquare(bishops), occupied);
+	}
+	Bitboard rooks = chess_board.GetPieces(attacker, Piece::Rook) | queens;
+	while (rooks)
+	{
+		attacked |= RookAttacks(PopLowestSquare(rooks), occupied);
+	}
+	Bitboard kings = chess_board.GetPieces(attacker, Piece::King);
+	if (kings)
+	{
+		attacked |= KingAttacks(LowestSquare(kings));
+	}
+	return attacked;
+}
+
+/**
+ * @param piece: The type of piece. Must be a knight, bishop, rook or queen.
+ * @param square: The square the piece is on
+ * @param occupied: Every occupied square on the board
+ * @return: The squares the piece attacks.
+ */
+static Bitboard PieceAttacks(Piece piece, int square, Bitboard occupied)
+{
+	switch (piece)
+	{
+	case Piece::Knight:
+		return KnightAttacks(square);
+	case Piece::Bishop:
+		return BishopAttacks(square, occupied);
+	case Piece::Rook:
+		return RookAttacks(square, occupied);
+	case Piece::Queen:
+		return QueenAttacks(square, occupied);
+	default:
+		return kEmptyBitboard;
+	}
+}
+
+/**
+ * Adds a move for a pawn, expanding it into the four possible promotions if the pawn reaches the last row.
+ *
+ * @param start: The square the pawn starts on
+ * @param end: The square the pawn is moved to
+ * @param promotion_row: The row on which the pawn promotes
+ * @param move_list: The list to add the move(s) to
+ * @return: None
+ */
+static void AddPawnMove(int start, int end, int promotion_row, MoveList& move_list)
+{
+	if (end / 8 != promotion_row)
+	{
+		move_list.Add(Move(start, end));
+		return;
+	}
+	move_list.Add(Move(start, end, MoveType::Promotion, Piece::Queen));
+	move_list.Add(Move(start, end, MoveType::Promotion, Piece::Rook));
+	move_list.Add(Move(start, end, MoveType::Promotion, Piece::Bishop));
+	move_list.Add(Move(start, end, MoveType::Promotion, Piece::Knight));
+}
+
+/**
+ * Adds the legal pawn moves of the given kind for the side to move, including double steps, promotions and en passant.
+ *
+ * @param chess_board: The board
+ * @param king_square: The square of the moving side's king
+ * @param targets: The squares a move must end on. When in check, these are the squares that capture or block the checker.
+ * @param pinned: The moving side's pieces that are pinned to their king
+ * @param type: Which moves to add. Promotions count as captures.
+ * @param starts: Only pawns on these squares are moved
+ * @param move_list: The list to add moves to
+ * @return: None
+ */
+static void GeneratePawnMoves(const ChessBoard& chess_board, int king_square, Bitboard targets, Bitboard pinned, MoveGenType type,
+	Bitboard starts, MoveList& move_list)
+{
+	Color us = chess_board.GetSideToMove();
+	Color them = GetOppositeColor(us);
+	Bitboard occupied = chess_board.GetOccupied();
+	Bitboard theirs = chess_board.GetOccupancy(them);
+	int forward = us == Color::White ? -8 : 8;
+	int start_row = us == Color::White ? 6 : 1;
+	int promotion_row = us == Color::White ? 0 : 7;
+	int en_passant_square = chess_board.GetEnPassantSquare();
+
+	Bitboard pawns = chess_board.GetPieces(us, Piece::Pawn) & starts;
+	while (pawns)
+	{
+		int start = PopLowestSquare(pawns);
+		Bitboard allowed = targets;
+		if (pinned & SquareBit(start))
+		{
+			allowed &= LineThrough(king_square, start);
+		}
+
+		Bitboard moves = type != MoveGenType::Quiets ? PawnAttacks(us, start) & theirs & allowed : kEmptyBitboard;
+		int one_step = start + forward;
+		// A step forward is a quiet move unless it promotes.
+		bool promotes = one_step / 8 == promotion_row;
+		if ((type == MoveGenType::All || (type == MoveGenType::Captures) == promotes) && !(occupied & SquareBit(one_step)))
+		{
+			moves |= SquareBit(one_step) & allowed;
+			int two_steps = one_step + forward;
+			if (start / 8 == start_row && !(occupied & SquareBit(two_steps)))
+			{
+				moves |= SquareBit(two_steps) & allowed;
+			}
+		}
+		while (moves)
+		{
+			AddPawnMove(start, PopLowestSquare(moves), promotion_row, move_list);
+		}
+
+		/**
+		 * En passant removes two pieces from the row at once, which can uncover an attack on the king
+		 * that the pin test does not see. It is rare, so the position after the capture is simply tested directly.
+		 */
+		if (type != MoveGenType::Quiets && en_passant_square != kNoSquare && (PawnAttacks(us, start) & SquareBit(en_passant_square)))
+		{
+			int captured = en_passant_square - forward;
+			if (!(chess_board.GetPieces(them, Piece::Pawn) & SquareBit(captured)))
+			{
+				continue;
+			}
+			Bitboard after = (occupied ^ SquareBit(start) ^ SquareBit(captured)) | SquareBit(en_passant_square);
+			if (!(AttackersTo(chess_board, king_square, after) & theirs & ~SquareBit(captured)))
+			{
+				move_list.Add(Move(start, en_passant_square, MoveType::EnPassant));
+			}
+		}
+	}
+}
+
+/**
+ * Checks whether the side to move may castle with the rook in the given column. The king and rook must
+ * not have moved, the squares between them must be empty, and the king may not pass through or land on
+ * an attacked square. The caller makes sure the king is not currently in check.
+ *
+ * @param chess_board: The board
+ * @param rook_column: 7 for the king side rook, 0 for the queen side rook
+ * @return: True if castling is legal, false otherwise.
+ */
+static bool CanCastle(const ChessBoard& chess_board, int rook_column)
+{
+	Color us = chess_board.GetSideToMove();
+	Color them = GetOppositeColor(us);
+	int back_row = us == Color::White ? 7 : 0;
+	int king_square = back_row * 8 + 4;
+	int rook_square = back_row * 8 + rook_column;
+	int king_end = back_row * 8 + (rook_column == 7 ? 6 : 2);
+
+	const ChessPiece& king = chess_board.GetPieceAt(king_square);
+	const ChessPiece& rook = chess_board.GetPieceAt(rook_square);
+	if (king.GetPiece() != Piece::King || king.GetColor() != us || king.GetHasMoved() ||
+		rook.GetPiece() != Piece::Rook || rook.GetColor() != us || rook.GetHasMoved())
+	{
+		return false;
+	}
+
+	Bitboard occupied = chess_board.GetOccupied();
+	if (BetweenSquares(king_square, rook_square) & occupied)
+	{
+		return false;
+	}
+
+	Bitboard path = BetweenSquares(king_square, king_end) | SquareBit(king_end);
+	while (path)
+	{
+		if (AttackersTo(chess_board, PopLowestSquare(path), occupied) & chess_board.GetOccupancy(them))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * Lists the legal moves of the pieces on some squares in one pass. Rather than trying each move and testing
+ * the result, the generator first finds the pieces giving check and the pieces pinned to the king, and then
+ * only produces moves that respect them.
+ *
+ * @param chess_board: The board
+ * @param type: Which moves to list
+ * @param starts: Only pieces on these squares are moved
+ * @param move_list: The list that is filled with the legal moves. Anything already in it is cleared.
+ * @return: None
+ */
+static void GenerateMoves(const ChessBoard& chess_board, MoveGenType type, Bitboard starts, MoveList& move_list)
+{
+	move_list.Clear();
+	Color us = chess_board.GetSideToMove();
+	Color them = GetOppositeColor(us);
+	Bitboard ours = chess_board.GetOccupancy(us);
+	Bitboard theirs = chess_board.GetOccupancy(them);
+	Bitboard occupied = chess_board.GetOccupied();
+	// The squares each kind of move may end on, before check and pins are taken into account.
+	Bitboard kind_targets = type == MoveGenType::Captures ? theirs : type == MoveGenType::Quiets ? ~occupied : ~ours;
+
+	// A player whose king has been taken has no moves left.
+	Bitboard king = chess_board.GetPieces(us, Piece::King);
+	if (king == kEmptyBitboard)
+	{
+		return;
+	}
+	int king_square = LowestSquare(king);
+	Bitboard checkers = AttackersTo(chess_board, king_square, occupied) & theirs;
+
+	// The king is taken off the board while testing its moves so it cannot shelter behind itself on a ray.
+	Bitboard king_moves = (king & starts) ? KingAttacks(king_square) & kind_targets : kEmptyBitboard;
+	while (king_moves)
+	{
+		int end = PopLowestSquare(king_moves);
+		if (!(AttackersTo(chess_board, end, occupied ^ king) & theirs))
+		{
+			move_list.Add(Move(king_square, end));
+		}
+	}
+
+	// In double check only the king can move.
+	if (PopCount(checkers) > 1)
+	{
+		return;
+	}
+
+	// In single check every other move must capture the checker or block its path.
+	Bitboard targets = ~ours;
+	if (checkers)
+	{
+		targets = BetweenSquares(king_square, LowestSquare(checkers)) | checkers;
+	}
+	Bitboard piece_targets = targets & kind_targets;
+
+	// A piece is pinned if it is the only piece between the king and an enemy slider on the same line.
+	Bitboard pinned = kEmptyBitboard;
+	Bitboard enemy_queens = chess_board.GetPieces(them, Piece::Queen);
+	Bitboard snipers = (RookAttacks(king_square, kEmptyBitboard) & (chess_board.GetPieces(them, Piece::Rook) | enemy_queens))
+		| (BishopAttacks(king_square, kEmptyBitboard) & (chess_board.GetPieces(them, Piece::Bishop) | enemy_queens));
+	while (snipers)
+	{
+		Bitboard blockers = BetweenSquares(king_square, PopLowestSquare(snipers)) & occupied;
+		if (PopCount(blockers) == 1 && (blockers & ours))
+		{
+			pinned |= blockers;
+		}
+	}
+
+	for (Piece piece : { Piece::Knight, Piece::Bishop, Piece::Rook, Piece::Queen })
+	{
+		Bitboard pieces = chess_board.GetPieces(us, piece) & starts;
+		while (pieces)
+		{
+			int start = PopLowestSquare(pieces);
+			Bitboard moves = PieceAttacks(piece, start, occupied) & piece_targets;
+			// A pinned piece may only move along the line between its king and the pinning piece.
+			if (pinned & SquareBit(start))
+			{
+				moves &= LineThrough(king_square, start);
+			}
+			while (moves)
+			{
+				move_list.Add(Move(start, PopLowestSquare(moves)));
+			}
+		}
+	}
+
+	GeneratePawnMoves(chess_board, king_square, targets, pinned, type, starts, move_list);
+
+	if (!checkers && type != MoveGenType::Captures && (king & starts))
+	{
+		int back_row = us == Color::White ? 7 : 0;
+		if (CanCastle(chess_board, 7))
+		{
+			move_list.Add(Move(back_row * 8 + 4, back_row * 8 + 6, MoveType::Castling));
+		}
+		if (CanCastle(chess_board, 0))
+		{
+			move_list.Add(Move(back_row * 8 + 4, back_row * 8 + 2, MoveType::Castling));
+		}
+	}
+}
+
+/**
+ * Lists the legal moves of one kind for the side to move. Captures and quiet moves together make up all of them.
+ *
+ * @param chess_board: The board
+ * @param move_list: The list that is filled with the legal moves. Anything already in it is cleared.
+ * @param type: Which moves to list
+ * @return: None
+ */
+void GenerateLegalMoves(const ChessBoard& chess_board, MoveList& move_list, MoveGenType type)
+{
+	GenerateMoves(chess_board, type, ~kEmptyBitboard, move_list);
+}
+
+/**
+ * Checks a move that was not generated for this position, such as one from the transposition table, without
+ * listing every move: only the moves of the piece on the move's start square are generated.
+ *
+ * @param chess_board: The board
+ * @param move: The move to check
+ * @return: True if the move is legal in this position, false otherwise.
+ */
+bool IsLegalMove(const ChessBoard& chess_board, Move move)
+{
+	const ChessPiece& chess_piece = chess_board.GetPieceAt(move.GetStart());
+	if (chess_piece.GetPiece() == Piece::Empty || chess_piece.GetColor() != chess_board.GetSideToMove())
+	{
+		return false;
+	}
+	MoveList move_list;
+	GenerateMoves(chess_board, MoveGenType::All, SquareBit(move.GetStart()), move_list);
+	for (Move legal_move : move_list)
+	{
+		if (legal_move == move)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * Reads a move in coordinate notation, such as "e2e4" or "e7e8q", and finds it among the legal moves.
+ *
+ * @param chess_board: The position the move is played from
+ * @param text: The move. Only the first four or five characters are read.
+ * @return: The move, or an empty move if the text is not a legal move in this position.
+ */
+Move ParseMove(const ChessBoard& chess_board, const char* text)
+{
+	for (int i = 0; i < 4; i++)
+	{
+		if (text[i] < (i % 2 == 0 ? 'a' : '1') || text[i] > (i % 2 == 0 ? 'h' : '8'))
+		{
+			return Move();
+		}
+	}
+	int start = ('8' - text[1]) * 8 + (text[0] - 'a');
+	int end = ('8' - text[3]) * 8 + (text[2] - 'a');
+	Piece promotion;
+	switch (text[4])
+	{
+	case 'q': promotion = Piece::Queen; break;
+	case 'r': promotion = Piece::Rook; break;
+	case 'b': promotion = Piece::Bishop; break;
+	case 'n': promotion = Piece::Knight; break;
+	default: promotion = Piece::Empty; break;
+	}
+
+	MoveList move_list;
+	GenerateLegalMoves(chess_board, move_list);
+	for (Move move : move_list)
+	{
+		if (move.GetStart() == start && move.GetEnd() == end
+			&& (move.GetType() == MoveType::Promotion ? move.GetPromotion() : Piece::Empty) == promotion)
+		{
+			return move;
+		}
+	}
+	return Move();
+}
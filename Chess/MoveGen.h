@@ -0,0 +1,51 @@
+#pragma once
+#include "ChessBoard.h"
+#include "Bitboard.h"
+#include "Magic.h"
+#include "Move.h"
+
+#include <array>
+using std::array;
+
+/**
+ * A fixed size list of moves. No position has more than 218 legal moves, so the list never
+ * needs to allocate and can live on the stack of a search.
+ */
+class MoveList
+{
+private:
+	array<Move, 256> moves_;
+	int size_ = 0;
+
+public:
+	void Add(Move move) { moves_[size_++] = move; }
+	void Clear() { size_ = 0; }
+	int Size() const { return size_; }
+
+	Move& operator[](int index) { return moves_[index]; }
+	const Move& operator[](int index) const { return moves_[index]; }
+	Move* begin() { return moves_.data(); }
+	Move* end() { return moves_.data() + size_; }
+	const Move* begin() const { return moves_.data(); }
+	const Move* end() const { return moves_.data() + size_; }
+};
+
+/**
+ * Which moves to generate. Captures include en passant and every promotion, since they change the material
+ * on the board; quiet moves are everything else, including castling.
+ */
+enum class MoveGenType { All, Captures, Quiets };
+
+Bitboard AttackersTo(const ChessBoard& chess_board, int square, Bitboard occupied);
+
+bool IsSquareAttacked(const ChessBoard& chess_board, int square, Color attacker);
+
+bool IsInCheck(const ChessBoard& chess_board);
+
+Bitboard AttackedSquares(const ChessBoard& chess_board, Color attacker, Bitboard occupied);
+
+void GenerateLegalMoves(const ChessBoard& chess_board, MoveList& move_list, MoveGenType type = MoveGenType::All);
+
+bool IsLegalMove(const ChessBoard& chess_board, Move move);
+
+Move ParseMove(const ChessBoard& chess_board, const char* text);
@@ -0,0 +1,248 @@
+#include "MovePicker.h"
+#include "Evaluation.h"
+
+#include <algorithm>
+#include <utility>
+
+/**
+ * Works out what a capture wins or loses once both sides have made every capture on its square that pays,
+ * each side always capturing with its least valuable piece. Pieces behind a capturing slider join in once it
+ * has moved. A pawn that promotes gains the promoted piece less the pawn, and is then worth the promoted piece
+ * to the side that takes it; a pawn recapturing onto the last rank is taken to make a queen. Pins are not
+ * taken into account.
+ *
+ * @param chess_board: The position before the capture
+ * @param move: The capture
+ * @return: The material the capturing side comes out with in hundredths of a pawn, which is negative if the capture loses material.
+ */
+int StaticExchange(const ChessBoard& chess_board, Move move)
+{
+	int start = move.GetStart();
+	int end = move.GetEnd();
+	Bitboard occupied = chess_board.GetOccupied() ^ SquareBit(start);
+	Piece victim = chess_board.GetPieceAt(end).GetPiece();
+	if (move.GetType() == MoveType::EnPassant)
+	{
+		victim = Piece::Pawn;
+		occupied ^= SquareBit(chess_board.GetSideToMove() == Color::White ? end + 8 : end - 8);
+	}
+
+	// gains[n] is what the side making the nth capture has won if the exchange stops after it.
+	array<int, 32> gains;
+	int depth = 0;
+	gains[0] = kPieceValues[static_cast<int>(victim)];
+	int on_square = kPieceValues[static_cast<int>(chess_board.GetPieceAt(start).GetPiece())];
+	int promotion_gain = kPieceValues[static_cast<int>(Piece::Queen)] - kPieceValues[static_cast<int>(Piece::Pawn)];
+	if (move.GetType() == MoveType::Promotion)
+	{
+		gains[0] += kPieceValues[static_cast<int>(move.GetPromotion())] - kPieceValues[static_cast<int>(Piece::Pawn)];
+		on_square = kPieceValues[static_cast<int>(move.GetPromotion())];
+	}
+	bool last_rank = end < 8 || end >= 56;
+	Color side = GetOppositeColor(chess_board.GetSideToMove());
+	for (;;)
+	{
+		Bitboard attackers = AttackersTo(chess_board, end, occupied) & occupied;
+		Bitboard side_attackers = attackers & chess_board.GetOccupancy(side);
+		if (!side_attackers)
+		{
+			break;
+		}
+		Piece piece = Piece::Pawn;
+		while (!(side_attackers & chess_board.GetPieces(piece)))
+		{
+			piece = static_cast<Piece>(static_cast<int>(piece) + 1);
+		}
+		// The king may only capture last, onto a square the other side no longer attacks.
+		if (piece == Piece::King && (attackers & chess_board.GetOccupancy(GetOppositeColor(side))))
+		{
+			break;
+		}
+		depth++;
+		bool promotes = piece == Piece::Pawn && last_rank;
+		gains[depth] = on_square - gains[depth - 1] + (promotes ? promotion_gain : 0);
+		on_square = kPieceValues[static_cast<int>(promotes ? Piece::Queen : piece)];
+		occupied ^= SquareBit(LowestSquare(side_attackers & chess_board.GetPieces(piece)));
+		side = GetOppositeColor(side);
+	}
+	// Either side may decline to recapture, so each keeps the better of stopping or going on.
+	while (depth > 0)
+	{
+		gains[depth - 1] = -std::max(-gains[depth - 1], gains[depth]);
+		depth--;
+	}
+	return gains[0];
+}
+
+/**
+ * Picks the moves of a node of the main search.
+ *
+ * @param chess_board: The position, which must be the same each time Next is called
+ * @param hash_move: The transposition table's move for the position, or an empty move. It is checked for legality before it is used.
+ * @param killers: The killer moves of the position's ply. They are also checked before they are used.
+ * @param history: The history scores of quiet moves
+ */
+MovePicker::MovePicker(const ChessBoard& chess_board, Move hash_move, const array<Move, 2>& killers, const HistoryTable& history)
+	: board_(chess_board), hash_move_(hash_move), killers_(killers), history_(&history)
+{
+}
+
+/**
+ * Picks only the captures and promotions of a position, for the quiescence search.
+ *
+ * @param chess_board: The position, which must be the same each time Next is called
+ */
+MovePicker::MovePicker(const ChessBoard& chess_board)
+	: board_(chess_board), captures_only_(true), stage_(PickStage::GenerateCaptures)
+{
+}
+
+/**
+ * Takes the highest scoring move left in the current stage. Once the best score left is 0 or less, the
+ * rest of the moves are handed out in the order they were generated rather than searched for each time.
+ *
+ * @return: The move, or an empty move if the stage has none left.
+ */
+Move MovePicker::PickBest()
+{
+	if (next_ >= moves_.Size())
+	{
+		return Move();
+	}
+	if (selecting_)
+	{
+		int best = next_;
+		for (int i = next_ + 1; i < moves_.Size(); i++)
+		{
+			if (scores_[i] > scores_[best])
+			{
+				best = i;
+			}
+		}
+		std::swap(moves_[next_], moves_[best]);
+		std::swap(scores_[next_], scores_[best]);
+		selecting_ = scores_[next_] > 0;
+	}
+	return moves_[next_++];
+}
+
+/**
+ * @param move: A quiet move
+ * @return: True if the move was already handed out as the hash move or a killer.
+ */
+bool MovePicker::IsPicked(Move move) const
+{
+	return move == hash_move_ || move == killers_[0] || move == killers_[1];
+}
+
+/**
+ * Hands out the next move, generating the next stage's moves when the current stage runs out.
+ *
+ * @return: The next legal move, or an empty move once every move has been handed out.
+ */
+Move MovePicker::Next()
+{
+	for (;;)
+	{
+		switch (stage_)
+		{
+		case PickStage::HashMove:
+			stage_ = PickStage::GenerateCaptures;
+			if (hash_move_ != Move() && IsLegalMove(board_, hash_move_))
+			{
+				return hash_move_;
+			}
+			hash_move_ = Move();
+			break;
+
+		case PickStage::GenerateCaptures:
+			GenerateLegalMoves(board_, moves_, MoveGenType::Captures);
+			for (int i = 0; i < moves_.Size(); i++)
+			{
+				// Most valuable victim first, and the least valuable attacker among captures of the same victim.
+				Move move = moves_[i];
+				Piece victim = move.GetType() == MoveType::EnPassant ? Piece::Pawn : board_.GetPieceAt(move.GetEnd()).GetPiece();
+				scores_[i] = 10 * kPieceValues[static_cast<int>(victim)] - kPieceValues[static_cast<int>(board_.GetPieceAt(move.GetStart()).GetPiece())];
+				if (move.GetType() == MoveType::Promotion)
+				{
+					scores_[i] += kPieceValues[static_cast<int>(move.GetPromotion())];
+				}
+			}
+			next_ = 0;
+			selecting_ = true;
+			stage_ = PickStage::GoodCaptures;
+			break;
+
+		case PickStage::GoodCaptures:
+			for (Move move = PickBest(); move != Move(); move = PickBest())
+			{
+				if (move == hash_move_)
+				{
+					continue;
+				}
+				if (board_.GetPieceAt(move.GetEnd()).GetPiece() != Piece::Empty && StaticExchange(board_, move) < 0)
+				{
+					bad_captures_.Add(move);
+					continue;
+				}
+				return move;
+			}
+			next_ = 0;
+			stage_ = captures_only_ ? PickStage::BadCaptures : PickStage::Killers;
+			break;
+
+		case PickStage::Killers:
+			while (killer_index_ < 2)
+			{
+				Move& killer = killers_[killer_index_++];
+				// A killer comes from another position, so it may not be quiet or even legal here.
+				if (killer != Move() && killer != hash_move_ && (killer_index_ == 1 || killer != killers_[0])
+					&& killer.GetType() != MoveType::Promotion && killer.GetType() != MoveType::EnPassant
+					&& board_.GetPieceAt(killer.GetEnd()).GetPiece() == Piece::Empty && IsLegalMove(board_, killer))
+				{
+					return killer;
+				}
+				killer = Move();
+			}
+			stage_ = PickStage::GenerateQuiets;
+			break;
+
+		case PickStage::GenerateQuiets:
+		{
+			GenerateLegalMoves(board_, moves_, MoveGenType::Quiets);
+			const auto& history = (*history_)[ColorIndex(board_.GetSideToMove())];
+			for (int i = 0; i < moves_.Size(); i++)
+			{
+				scores_[i] = history[moves_[i].GetStart()][moves_[i].GetEnd()];
+			}
+			next_ = 0;
+			selecting_ = true;
+			stage_ = PickStage::Quiets;
+			break;
+		}
+
+		case PickStage::Quiets:
+			for (Move move = PickBest(); move != Move(); move = PickBest())
+			{
+				if (!IsPicked(move))
+				{
+					return move;
+				}
+			}
+			next_ = 0;
+			stage_ = PickStage::BadCaptures;
+			break;
+
+		case PickStage::BadCaptures:
+			if (next_ < bad_captures_.Size())
+			{
+				return bad_captures_[next_++];
+			}
+			stage_ = PickStage::Done;
+			break;
+
+		case PickStage::Done:
+			return Move();
+		}
+	}
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include "ChessBoard.h"
+#include "MoveGen.h"
+
+#include <array>
+using std::array;
+
+// Indexed by ColorIndex, start square and end square: how often a quiet move has caused a beta cutoff.
+using HistoryTable = array<array<array<int, 64>, 64>, 2>;
+
+/**
+ * The stages a MovePicker goes through, in order. Each list of moves is only generated when the stage
+ * before it has run out.
+ */
+enum class PickStage { HashMove, GenerateCaptures, GoodCaptures, Killers, GenerateQuiets, Quiets, BadCaptures, Done };
+
+/**
+ * Hands out the legal moves of a position one at a time, best first, without generating them all up front.
+ * Most beta cutoffs come from one of the first few moves, so the moves after the cutoff are never generated
+ * or sorted at all.
+ *
+ * The order is the transposition table move, then captures and promotions that do not lose material, most
+ * valuable victim and least valuable attacker first, then the two killer moves, then quiet moves with a
+ * history score, best first, then the remaining quiet moves, and last the captures that lose material.
+ * The quiescence search only asks for captures.
+ */
+class MovePicker
+{
+private:
+	const ChessBoard& board_;
+	Move hash_move_;
+	array<Move, 2> killers_;
+	const HistoryTable* history_ = nullptr;
+	bool captures_only_ = false;
+	PickStage stage_ = PickStage::HashMove;
+
+	// The moves of the current stage, their scores, and the next one to hand out.
+	MoveList moves_;
+	array<int, 256> scores_;
+	int next_ = 0;
+	// Cleared once the best score left is 0 or less, after which the moves are taken in order.
+	bool selecting_ = true;
+	// Captures that lose material, kept for the last stage.
+	MoveList bad_captures_;
+	int killer_index_ = 0;
+
+	Move PickBest();
+	bool IsPicked(Move move) const;
+
+public:
+	MovePicker(const ChessBoard& chess_board, Move hash_move, const array<Move, 2>& killers, const HistoryTable& history);
+	explicit MovePicker(const ChessBoard& chess_board);
+
+	Move Next();
+	PickStage GetStage() const { return stage_; }
+};
+
+int StaticExchange(const ChessBoard& chess_board, Move move);
@@ -0,0 +1,217 @@
+#include "Network.h"
+#include "MappedFile.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define CHESS_NETWORK_SSE2
+#endif
+
+/**
+ * @param data: Two bytes, least significant first
+ * @return: The signed 16-bit number they hold.
+ */
+static int16_t ReadInt16(const unsigned char* data)
+{
+	return static_cast<int16_t>(data[0] | (data[1] << 8));
+}
+
+/**
+ * Reads a network file, replacing the network already loaded.
+ *
+ * @param path: The file to read
+ * @return: True if the network was read, false if the file is missing or too short, which leaves no network loaded.
+ */
+bool Network::Load(const string& path)
+{
+	hidden_weights_.clear();
+	const size_t value_count = kNetworkInputs * kNetworkHidden + kNetworkHidden + kNetworkHidden * 2 + 1;
+	MappedFile file;
+	if (!file.Open(path) || file.GetSize() < value_count * 2)
+	{
+		return false;
+	}
+	const unsigned char* data = reinterpret_cast<const unsigned char*>(file.GetData());
+	vector<int16_t> hidden_weights(kNetworkInputs * kNetworkHidden);
+	for (int16_t& weight : hidden_weights)
+	{
+		weight = ReadInt16(data);
+		data += 2;
+	}
+	for (int16_t& bias : hidden_biases_)
+	{
+		bias = ReadInt16(data);
+		data += 2;
+	}
+	for (int16_t& weight : output_weights_)
+	{
+		weight = ReadInt16(data);
+		data += 2;
+	}
+	output_bias_ = ReadInt16(data);
+	hidden_weights_ = std::move(hidden_weights);
+	return true;
+}
+
+/**
+ * @param perspective: The side whose hidden layer the input feeds
+ * @param color: The color of the piece
+ * @param piece: The piece
+ * @param square: The square it is on
+ * @return: The hidden layer weights of the input for the piece, kNetworkHidden of them.
+ */
+const int16_t* Network::GetWeights(Color perspective, Color color, Piece piece, int square) const
+{
+	// The board counts squares from a8, so white's side sees it flipped.
+	int relative_square = perspective == Color::White ? square ^ 56 : square;
+	int input = (color == perspective ? 0 : 384) + (static_cast<int>(piece) - 1) * 64 + relative_square;
+	return &hidden_weights_[static_cast<size_t>(input) * kNetworkHidden];
+}
+
+/**
+ * Adds or subtracts one input's weights from one side's hidden layer.
+ *
+ * @param values: The hidden layer, aligned to 32 bytes
+ * @param weights: The input's weights
+ * @param add: True to add the weights, false to subtract them
+ * @return: None
+ */
+static void UpdateValues(int16_t* values, const int16_t* weights, bool add)
+{
+#if defined(__AVX2__)
+	for (int i = 0; i < kNetworkHidden; i += 16)
+	{
+		__m256i value = _mm256_load_si256(reinterpret_cast<const __m256i*>(values + i));
+		__m256i weight = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(weights + i));
+		value = add ? _mm256_add_epi16(value, weight) : _mm256_sub_epi16(value, weight);
+		_mm256_store_si256(reinterpret_cast<__m256i*>(values + i), value);
+	}
+#elif defined(CHESS_NETWORK_SSE2)
+	for (int i = 0; i < kNetworkHidden; i += 8)
+	{
+		__m128i value = _mm_load_si128(reinterpret_cast<const __m128i*>(values + i));
+		__m128i weight = _mm_loadu_si128(reinterpret_cast<const __m128i*>(weights + i));
+		value = add ? _mm_add_epi16(value, weight) : _mm_sub_epi16(value, weight);
+		_mm_store_si128(reinterpret_cast<__m128i*>(values + i), value);
+	}
+#else
+	for (int i = 0; i < kNetworkHidden; i++)
+	{
+		values[i] = static_cast<int16_t>(add ? values[i] + weights[i] : values[i] - weights[i]);
+	}
+#endif
+}
+
+/**
+ * Clips one side's hidden layer to 0 to kNetworkHiddenScale and multiplies it by its output weights.
+ *
+ * @param values: The hidden layer, aligned to 32 bytes
+ * @param weights: The output weights for that side
+ * @return: The sum of the products.
+ */
+static int OutputSum(const int16_t* values, const int16_t* weights)
+{
+#if defined(__AVX2__)
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i ceiling = _mm256_set1_epi16(kNetworkHiddenScale);
+	__m256i sum = zero;
+	for (int i = 0; i < kNetworkHidden; i += 16)
+	{
+		__m256i value = _mm256_load_si256(reinterpret_cast<const __m256i*>(values + i));
+		value = _mm256_min_epi16(_mm256_max_epi16(value, zero), ceiling);
+		__m256i weight = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(weights + i));
+		// Multiplies pairs of 16-bit numbers and adds neighbouring products into 32 bits, so nothing overflows.
+		sum = _mm256_add_epi32(sum, _mm256_madd_epi16(value, weight));
+	}
+	__m128i total = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+	total = _mm_add_epi32(total, _mm_shuffle_epi32(total, 0x4E));
+	total = _mm_add_epi32(total, _mm_shuffle_epi32(total, 0xB1));
+	return _mm_cvtsi128_si32(total);
+#elif defined(CHESS_NETWORK_SSE2)
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i ceiling = _mm_set1_epi16(kNetworkHiddenScale);
+	__m128i sum = zero;
+	for (int i = 0; i < kNetworkHidden; i += 8)
+	{
+		__m128i value = _mm_load_si128(reinterpret_cast<const __m128i*>(values + i));
+		value = _mm_min_epi16(_mm_max_epi16(value, zero), ceiling);
+		__m128i weight = _mm_loadu_si128(reinterpret_cast<const __m128i*>(weights + i));
+		sum = _mm_add_epi32(sum, _mm_madd_epi16(value, weight));
+	}
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+	return _mm_cvtsi128_si32(sum);
+#else
+	int sum = 0;
+	for (int i = 0; i < kNetworkHidden; i++)
+	{
+		int value = values[i] < 0 ? 0 : values[i] > kNetworkHiddenScale ? kNetworkHiddenScale : values[i];
+		sum += value * weights[i];
+	}
+	return sum;
+#endif
+}
+
+/**
+ * Sets both sides' hidden layers to those of an empty board.
+ *
+ * @param accumulator: The hidden layers to set
+ * @return: None
+ */
+void Network::Clear(Accumulator& accumulator) const
+{
+	accumulator.values[0] = hidden_biases_;
+	accumulator.values[1] = hidden_biases_;
+}
+
+/**
+ * Updates both sides' hidden layers for a piece placed on the board.
+ *
+ * @param accumulator: The hidden layers to update
+ * @param color: The color of the piece
+ * @param piece: The piece
+ * @param square: The square it is placed on
+ * @return: None
+ */
+void Network::AddPiece(Accumulator& accumulator, Color color, Piece piece, int square) const
+{
+	for (Color perspective : { Color::White, Color::Black })
+	{
+		UpdateValues(accumulator.values[ColorIndex(perspective)].data(), GetWeights(perspective, color, piece, square), true);
+	}
+}
+
+/**
+ * Updates both sides' hidden layers for a piece taken off the board.
+ *
+ * @param accumulator: The hidden layers to update
+ * @param color: The color of the piece
+ * @param piece: The piece
+ * @param square: The square it is removed from
+ * @return: None
+ */
+void Network::RemovePiece(Accumulator& accumulator, Color color, Piece piece, int square) const
+{
+	for (Color perspective : { Color::White, Color::Black })
+	{
+		UpdateValues(accumulator.values[ColorIndex(perspective)].data(), GetWeights(perspective, color, piece, square), false);
+	}
+}
+
+/**
+ * Runs the output layer. The hidden weights and biases are stored multiplied by kNetworkHiddenScale, the
+ * output weights by kNetworkOutputScale and the output bias by both.
+ *
+ * @param accumulator: The hidden layers of the position
+ * @param side_to_move: Whose turn it is
+ * @return: The score in hundredths of a pawn from the point of view of the side to move, at most kMaxNetworkScore either way.
+ */
+int Network::Evaluate(const Accumulator& accumulator, Color side_to_move) const
+{
+	int us = ColorIndex(side_to_move);
+	int64_t sum = static_cast<int64_t>(OutputSum(accumulator.values[us].data(), &output_weights_[0]))
+		+ OutputSum(accumulator.values[1 - us].data(), &output_weights_[kNetworkHidden]) + output_bias_;
+	int64_t score = sum * kNetworkEvalScale / (kNetworkHiddenScale * kNetworkOutputScale);
+	return static_cast<int>(score < -kMaxNetworkScore ? -kMaxNetworkScore : score > kMaxNetworkScore ? kMaxNetworkScore : score);
+}
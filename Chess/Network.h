@@ -0,0 +1,66 @@
+#pragma once
+#include "ChessPiece.h"
+
+#include <array>
+using std::array;
+#include <cstdint>
+#include <string>
+using std::string;
+#include <vector>
+using std::vector;
+
+// The network's inputs are one per piece of each color on each square, and each side has its own hidden layer.
+const int kNetworkInputs = 768;
+const int kNetworkHidden = 256;
+// The hidden layer is clipped to 0 to kNetworkHiddenScale, which stands for 0 to 1.
+const int kNetworkHiddenScale = 255;
+// The output weights are stored multiplied by this.
+const int kNetworkOutputScale = 64;
+// Turns the network's output into hundredths of a pawn.
+const int kNetworkEvalScale = 400;
+// The most the network can score a position, in hundredths of a pawn. Even a network with extreme weights stays
+// well below the scores the search gives to mates and tablebase wins.
+const int kMaxNetworkScore = 10000;
+
+/**
+ * The hidden layer of a network for one position, once from white's side and once from black's, indexed by
+ * ColorIndex. Placing or removing a piece only adds or subtracts that piece's weights, so the board keeps
+ * it up to date as moves are made and unmade instead of working it out again for every evaluation.
+ */
+struct alignas(32) Accumulator
+{
+	array<array<int16_t, kNetworkHidden>, 2> values;
+};
+
+/**
+ * An efficiently updatable neural network evaluation: 768 inputs, a hidden layer of 256 for each side,
+ * then one output. Networks are trained elsewhere and loaded from a file of little-endian 16-bit integers:
+ *
+ *   Hidden weights (768 x 256, input by input), hidden biases (256),
+ *   output weights (256 for the side to move, then 256 for the other side), output bias (1)
+ *
+ * Anything after that is ignored. From a side's point of view, the input for a piece is 0 for its own
+ * pieces or 384 for the other side's, plus 64 times the piece (pawn 0 to king 5), plus the square counted
+ * from a1 as seen from that side, so the inputs of black's side are those of white's with the board flipped.
+ *
+ * The hidden layer is added up with AVX2 or SSE2 when the compiler targets them, and one element at a time otherwise.
+ */
+class Network
+{
+private:
+	vector<int16_t> hidden_weights_;
+	array<int16_t, kNetworkHidden> hidden_biases_{};
+	array<int16_t, kNetworkHidden * 2> output_weights_{};
+	int output_bias_ = 0;
+
+	const int16_t* GetWeights(Color perspective, Color color, Piece piece, int square) const;
+
+public:
+	bool Load(const string& path);
+	bool IsLoaded() const { return !hidden_weights_.empty(); }
+
+	void Clear(Accumulator& accumulator) const;
+	void AddPiece(Accumulator& accumulator, Color color, Piece piece, int square) const;
+	void RemovePiece(Accumulator& accumulator, Color color, Piece piece, int square) const;
+	int Evaluate(const Accumulator& accumulator, Color side_to_move) const;
+};
@@ -0,0 +1,82 @@
+#pragma once
+#include "ChessBoard.h"
+#include "MappedFile.h"
+#include "Pgn.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+using std::string;
+#include <vector>
+using std::vector;
+
+/**
+ * A Polyglot opening book is a file of 16 byte entries sorted by key. All numbers are big-endian.
+ *
+ *   key (8 bytes), move (2 bytes), weight (2 bytes), learn (4 bytes, unused here)
+ *
+ * The key is the Polyglot hash of a position and there is one entry for each book move from it.
+ * A move stores the end file in bits 0-2, the end rank in bits 3-5, the start file in bits 6-8, the start
+ * rank in bits 9-11 and the promotion piece in bits 12-14 (1 knight, 2 bishop, 3 rook, 4 queen).
+ * Ranks count from white's side, and castling is stored as the king taking its own rook.
+ */
+const size_t kPolyglotEntrySize = 16;
+// The most moves kept from any one position.
+const int kMaxBookMoves = 64;
+
+struct PolyglotEntry
+{
+	uint64_t key = 0;
+	uint16_t move = 0;
+	uint16_t weight = 0;
+	uint32_t learn = 0;
+};
+
+// A book move from a position, with how often it should be played relative to the others.
+struct BookMove
+{
+	Move move;
+	int weight = 0;
+};
+
+uint64_t PolyglotKey(const ChessBoard& chess_board);
+
+uint16_t PolyglotMove(Move move);
+
+/**
+ * A Polyglot book mapped into memory. Opening it reads nothing but the file size; each probe is a binary
+ * search over the mapped entries, so only the few pages it touches are ever read from disk.
+ */
+class OpeningBook
+{
+private:
+	MappedFile file_;
+	size_t entry_count_ = 0;
+
+	uint64_t GetKey(size_t index) const;
+	PolyglotEntry GetEntry(size_t index) const;
+
+public:
+	bool Open(const string& path);
+	void Close();
+	bool IsOpen() const { return entry_count_ > 0; }
+	size_t GetEntryCount() const { return entry_count_; }
+
+	int Probe(const ChessBoard& chess_board, BookMove* moves, int max_moves) const;
+	Move PickMove(const ChessBoard& chess_board, uint64_t random) const;
+};
+
+/**
+ * Builds a Polyglot book from finished games. Each move of a game's opening is weighted by how the game
+ * went for the side that played it: two for a win, one for a draw and nothing for a loss.
+ */
+class OpeningBookWriter
+{
+private:
+	vector<PolyglotEntry> entries_;
+
+public:
+	bool AddGame(const PgnGame& game, int max_plies);
+	size_t GetEntryCount() const { return entries_.size(); }
+	bool Write(const string& path);
+};
@@ -0,0 +1,172 @@
+#include "ChessBoard.h"
+#include "MoveGen.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+using std::string;
+#include <vector>
+using std::vector;
+
+/**
+ * A test position and the published number of leaf nodes at each depth, starting at depth 1.
+ * The counts are the standard ones from the Chess Programming Wiki perft results page.
+ */
+struct PerftPosition
+{
+	string name;
+	string fen;
+	vector<uint64_t> counts;
+	// The depth used when no depth is given on the command line, chosen to keep a full run short.
+	int default_depth;
+};
+
+static const vector<PerftPosition> kPerftPositions = {
+	{ "Start position", "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+		{ 20, 400, 8902, 197281, 4865609, 119060324 }, 5 },
+	{ "Kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+		{ 48, 2039, 97862, 4085603, 193690690 }, 4 },
+	{ "Position 3", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+		{ 14, 191, 2812, 43238, 674624, 11030083 }, 5 },
+	{ "Position 4", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+		{ 6, 264, 9467, 422333, 15833292 }, 4 },
+	{ "Position 5", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+		{ 44, 1486, 62379, 2103487, 89941194 }, 4 },
+	{ "Position 6", "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+		{ 46, 2079, 89890, 3894594, 164075551 }, 4 },
+};
+
+/**
+ * Counts the leaf nodes of the move tree to the given depth. Moves at the last level are counted
+ * straight from the move list rather than made.
+ *
+ * @param chess_board: The position to count from. It is returned unchanged.
+ * @param depth: The number of moves to look ahead. Must be at least 1.
+ * @return: The number of leaf nodes.
+ */
+static uint64_t Perft(ChessBoard& chess_board, int depth)
+{
+	MoveList move_list;
+	GenerateLegalMoves(chess_board, move_list);
+	if (depth == 1)
+	{
+		return move_list.Size();
+	}
+	uint64_t nodes = 0;
+	for (Move move : move_list)
+	{
+		chess_board.MakeMove(move);
+		nodes += Perft(chess_board, depth - 1);
+		chess_board.UnmakeMove();
+	}
+	return nodes;
+}
+
+/**
+ * @return: The number of seconds since some fixed point, for timing runs.
+ */
+static double Seconds()
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * Prints the number of leaf nodes below each legal move, followed by the total. Comparing this output
+ * against another engine's narrows a wrong count down to the move that causes it.
+ *
+ * @param chess_board: The position to divide
+ * @param depth: The depth to count to, including the first move
+ * @return: None
+ */
+static void Divide(ChessBoard& chess_board, int depth)
+{
+	MoveList move_list;
+	GenerateLegalMoves(chess_board, move_list);
+	uint64_t total = 0;
+	double start = Seconds();
+	for (Move move : move_list)
+	{
+		uint64_t nodes = 1;
+		if (depth > 1)
+		{
+			chess_board.MakeMove(move);
+			nodes = Perft(chess_board, depth - 1);
+			chess_board.UnmakeMove();
+		}
+		cout << move << ": " << nodes << '\n';
+		total += nodes;
+	}
+	double elapsed = Seconds() - start;
+	cout << "\nMoves: " << move_list.Size() << "\nNodes: " << total
+		<< "\nNodes per second: " << static_cast<uint64_t>(total / (elapsed > 0 ? elapsed : 1e-9)) << endl;
+}
+
+/**
+ * Runs every standard position and compares the counts with the reference numbers.
+ *
+ * @param max_depth: The depth to run each position to, or 0 to use each position's default depth.
+ * Positions are never run deeper than their reference data.
+ * @return: True if every count matched, false otherwise.
+ */
+static bool RunSuite(int max_depth)
+{
+	bool all_passed = true;
+	uint64_t total_nodes = 0;
+	double total_time = 0;
+	ChessBoard chess_board;
+	for (const PerftPosition& position : kPerftPositions)
+	{
+		int depth = max_depth > 0 ? max_depth : position.default_depth;
+		if (depth > static_cast<int>(position.counts.size()))
+		{
+			depth = static_cast<int>(position.counts.size());
+		}
+		chess_board.FromFEN(position.fen.c_str());
+
+		double start = Seconds();
+		uint64_t nodes = Perft(chess_board, depth);
+		double elapsed = Seconds() - start;
+		total_nodes += nodes;
+		total_time += elapsed;
+
+		uint64_t expected = position.counts[depth - 1];
+		bool passed = nodes == expected;
+		all_passed = all_passed && passed;
+		cout << (passed ? "[ OK ] " : "[FAIL] ") << position.name << " depth " << depth << ": " << nodes;
+		if (!passed)
+		{
+			cout << " (expected " << expected << ")";
+		}
+		cout << ", " << elapsed << " s, " << static_cast<uint64_t>(nodes / (elapsed > 0 ? elapsed : 1e-9)) << " nodes/s\n";
+	}
+	cout << "\nTotal: " << total_nodes << " nodes in " << total_time << " s, "
+		<< static_cast<uint64_t>(total_nodes / (total_time > 0 ? total_time : 1e-9)) << " nodes/s" << endl;
+	return all_passed;
+}
+
+/**
+ * Usage:
+ *   perft                        Run the standard positions at their default depths.
+ *   perft <depth>                Run the standard positions to the given depth.
+ *   perft divide <depth> [fen]   Print the count below each move of a position (the start position by default).
+ *
+ * @return: 0 if every count matched the reference numbers, 1 otherwise.
+ */
+int main(int argc, char* argv[])
+{
+	if (argc >= 3 && string(argv[1]) == "divide")
+	{
+		ChessBoard chess_board;
+		chess_board.Reset();
+		if (argc >= 4 && !chess_board.FromFEN(argv[3]))
+		{
+			cout << "Could not read the position " << argv[3] << endl;
+			return 1;
+		}
+		Divide(chess_board, std::atoi(argv[2]));
+		return 0;
+	}
+	int max_depth = argc >= 2 ? std::atoi(argv[1]) : 0;
+	return RunSuite(max_depth) ? 0 : 1;
+}
@@ -0,0 +1,525 @@
+#include "Pgn.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+// Lines of movetext are wrapped before this length, as the PGN standard asks.
+const size_t kPgnLineLength = 79;
+
+/**
+ * @param name: The tag name, such as "White"
+ * @return: The value of the tag, or nullptr if the game does not have it.
+ */
+const string* PgnGame::GetTag(const string& name) const
+{
+	for (const auto& tag : tags)
+	{
+		if (tag.first == name)
+		{
+			return &tag.second;
+		}
+	}
+	return nullptr;
+}
+
+/**
+ * @return: The piece named by an upper case SAN letter, or Piece::Empty if the letter does not name one.
+ */
+static Piece PieceFromLetter(char letter)
+{
+	switch (letter)
+	{
+	case 'N': return Piece::Knight;
+	case 'B': return Piece::Bishop;
+	case 'R': return Piece::Rook;
+	case 'Q': return Piece::Queen;
+	case 'K': return Piece::King;
+	default: return Piece::Empty;
+	}
+}
+
+/**
+ * Resolves a move in Standard Algebraic Notation, such as "Nbd7", "exd6", "e8=Q+" or "O-O-O", against the
+ * legal moves of a position. Check and annotation marks at the end are ignored.
+ *
+ * @param chess_board: The position the move is played from
+ * @param text: The move. It does not need to be null terminated.
+ * @param length: The number of characters in the move
+ * @return: The move, or an empty move if it is not legal or does not name exactly one legal move.
+ */
+Move ParseSAN(const ChessBoard& chess_board, const char* text, size_t length)
+{
+	while (length > 0 && std::strchr("+#!?", text[length - 1]) != nullptr)
+	{
+		length--;
+	}
+	if (length < 2)
+	{
+		return Move();
+	}
+
+	MoveList move_list;
+	GenerateLegalMoves(chess_board, move_list);
+
+	// Castling is written as the king's move. Some files use zeros instead of the letter O.
+	if (text[0] == 'O' || text[0] == '0')
+	{
+		bool queen_side = length == 5;
+		if ((length != 3 && length != 5) || text[1] != '-' || text[2] != text[0])
+		{
+			return Move();
+		}
+		for (Move move : move_list)
+		{
+			if (move.GetType() == MoveType::Castling && (move.GetEnd() % 8 == 2) == queen_side)
+			{
+				return move;
+			}
+		}
+		return Move();
+	}
+
+	Piece piece = PieceFromLetter(text[0]);
+	size_t index = piece == Piece::Empty ? 0 : 1;
+	if (piece == Piece::Empty)
+	{
+		piece = Piece::Pawn;
+	}
+
+	Piece promotion = Piece::Empty;
+	if (PieceFromLetter(text[length - 1]) != Piece::Empty && piece == Piece::Pawn)
+	{
+		promotion = PieceFromLetter(text[length - 1]);
+		length -= text[length - 2] == '=' ? 2 : 1;
+	}
+	if (length < index + 2)
+	{
+		return Move();
+	}
+	char end_file = text[length - 2];
+	char end_rank = text[length - 1];
+	if (end_file < 'a' || end_file > 'h' || end_rank < '1' || end_rank > '8')
+	{
+		return Move();
+	}
+	int end = ('8' - end_rank) * 8 + (end_file - 'a');
+
+	// Anything between the piece letter and the destination is a capture mark or disambiguation.
+	int from_column = -1;
+	int from_row = -1;
+	for (; index < length - 2; index++)
+	{
+		char symbol = text[index];
+		if (symbol >= 'a' && symbol <= 'h')
+		{
+			from_column = symbol - 'a';
+		}
+		else if (symbol >= '1' && symbol <= '8')
+		{
+			from_row = '8' - symbol;
+		}
+		else if (symbol != 'x' && symbol != ':' && symbol != '-')
+		{
+			return Move();
+		}
+	}
+
+	Move found;
+	int matches = 0;
+	for (Move move : move_list)
+	{
+		int start = move.GetStart();
+		if (move.GetEnd() != end || chess_board.GetPieceAt(start).GetPiece() != piece
+			|| (from_column >= 0 && start % 8 != from_column) || (from_row >= 0 && start / 8 != from_row)
+			|| (move.GetType() == MoveType::Promotion ? move.GetPromotion() : Piece::Empty) != promotion
+			|| move.GetType() == MoveType::Castling)
+		{
+			continue;
+		}
+		found = move;
+		matches++;
+	}
+	return matches == 1 ? found : Move();
+}
+
+/**
+ * Writes a legal move in Standard Algebraic Notation, with the least disambiguation needed and a check
+ * or checkmate mark. The move is made and taken back to find out if it gives check.
+ *
+ * @param chess_board: The position the move is played from. It is returned unchanged.
+ * @param move: The move, which must be legal
+ * @param buffer: Where to write the move. Must hold at least 8 characters.
+ * @return: The number of characters written. The text is null terminated.
+ */
+int MoveToSAN(ChessBoard& chess_board, Move move, char* buffer)
+{
+	static const char kPieceLetters[7] = { ' ', ' ', 'N', 'B', 'R', 'Q', 'K' };
+	char* out = buffer;
+	int start = move.GetStart();
+	int end = move.GetEnd();
+	Piece piece = chess_board.GetPieceAt(start).GetPiece();
+	bool capture = chess_board.GetPieceAt(end).GetPiece() != Piece::Empty || move.GetType() == MoveType::EnPassant;
+
+	MoveList move_list;
+	GenerateLegalMoves(chess_board, move_list);
+	if (move.GetType() == MoveType::Castling)
+	{
+		std::strcpy(out, end % 8 == 2 ? "O-O-O" : "O-O");
+		out += end % 8 == 2 ? 5 : 3;
+	}
+	else
+	{
+		if (piece == Piece::Pawn)
+		{
+			if (capture)
+			{
+				*out++ = static_cast<char>('a' + start % 8);
+			}
+		}
+		else
+		{
+			*out++ = kPieceLetters[static_cast<int>(piece)];
+			// Another piece of the same kind that can reach the same square must be told apart by file, then rank.
+			bool ambiguous = false;
+			bool same_column = false;
+			bool same_row = false;
+			for (Move other : move_list)
+			{
+				if (other.GetEnd() == end && other.GetStart() != start && chess_board.GetPieceAt(other.GetStart()).GetPiece() == piece)
+				{
+					ambiguous = true;
+					same_column = same_column || other.GetStart() % 8 == start % 8;
+					same_row = same_row || other.GetStart() / 8 == start / 8;
+				}
+			}
+			if (ambiguous && (!same_column || same_row))
+			{
+				*out++ = static_cast<char>('a' + start % 8);
+			}
+			if (ambiguous && same_column)
+			{
+				*out++ = static_cast<char>('8' - start / 8);
+			}
+		}
+		if (capture)
+		{
+			*out++ = 'x';
+		}
+		*out++ = static_cast<char>('a' + end % 8);
+		*out++ = static_cast<char>('8' - end / 8);
+		if (move.GetType() == MoveType::Promotion)
+		{
+			*out++ = '=';
+			*out++ = kPieceLetters[static_cast<int>(move.GetPromotion())];
+		}
+	}
+
+	chess_board.MakeMove(move);
+	if (IsInCheck(chess_board))
+	{
+		MoveList replies;
+		GenerateLegalMoves(chess_board, replies);
+		*out++ = replies.Size() == 0 ? '#' : '+';
+	}
+	chess_board.UnmakeMove();
+	*out = '\0';
+	return static_cast<int>(out - buffer);
+}
+
+/**
+ * Skips white space, comments in braces and rest-of-line comments.
+ *
+ * @return: None
+ */
+void PgnReader::SkipSpace()
+{
+	while (position_ < end_)
+	{
+		char symbol = *position_;
+		if (symbol == ' ' || symbol == '\t' || symbol == '\n' || symbol == '\r')
+		{
+			position_++;
+		}
+		else if (symbol == '{')
+		{
+			const char* close = static_cast<const char*>(std::memchr(position_, '}', end_ - position_));
+			position_ = close != nullptr ? close + 1 : end_;
+		}
+		else if (symbol == ';')
+		{
+			const char* line_end = static_cast<const char*>(std::memchr(position_, '\n', end_ - position_));
+			position_ = line_end != nullptr ? line_end + 1 : end_;
+		}
+		else
+		{
+			break;
+		}
+	}
+}
+
+/**
+ * Reads one tag pair, such as [White "Carlsen, Magnus"]. The reader must be on the opening bracket.
+ *
+ * @param game: The game the tag is added to
+ * @return: True if the tag was read, false if it is malformed.
+ */
+bool PgnReader::ReadTag(PgnGame& game)
+{
+	position_++;
+	const char* name_start = position_;
+	while (position_ < end_ && *position_ != ' ' && *position_ != '"' && *position_ != ']')
+	{
+		position_++;
+	}
+	string name(name_start, position_);
+	while (position_ < end_ && *position_ == ' ')
+	{
+		position_++;
+	}
+	if (position_ >= end_ || *position_ != '"')
+	{
+		return false;
+	}
+	position_++;
+	string value;
+	for (; position_ < end_ && *position_ != '"'; position_++)
+	{
+		// A backslash escapes a quote or another backslash.
+		if (*position_ == '\\' && position_ + 1 < end_)
+		{
+			position_++;
+		}
+		value += *position_;
+	}
+	const char* close = position_ < end_ ? static_cast<const char*>(std::memchr(position_, ']', end_ - position_)) : nullptr;
+	if (close == nullptr)
+	{
+		position_ = end_;
+		return false;
+	}
+	position_ = close + 1;
+	if (name == "FEN")
+	{
+		game.fen = value;
+	}
+	game.tags.emplace_back(std::move(name), std::move(value));
+	return true;
+}
+
+/**
+ * Reads the movetext of a game up to and including its result, playing each move on the board. After an
+ * error the rest of the movetext is skipped, so the next game is still read correctly.
+ *
+ * @param game: The game the moves are added to
+ * @return: None
+ */
+void PgnReader::ReadMoves(PgnGame& game)
+{
+	int variation_depth = 0;
+	while (true)
+	{
+		SkipSpace();
+		// A tag at the start of a line means the result was missing and the next game has begun.
+		if (position_ >= end_ || (*position_ == '[' && variation_depth == 0))
+		{
+			return;
+		}
+		if (*position_ == '(' || *position_ == ')')
+		{
+			// Variations are alternatives to the game's moves and are skipped.
+			variation_depth += *position_ == '(' ? 1 : (variation_depth > 0 ? -1 : 0);
+			position_++;
+			continue;
+		}
+
+		const char* token = position_;
+		while (position_ < end_ && std::strchr(" \t\r\n{}();[", *position_) == nullptr)
+		{
+			position_++;
+		}
+		size_t length = position_ - token;
+		if (length == 0)
+		{
+			// A stray character, such as a closing brace with no opening brace.
+			position_++;
+			continue;
+		}
+		if (variation_depth > 0 || token[0] == '$')
+		{
+			continue;
+		}
+		if ((length == 3 && std::memcmp(token, "1-0", 3) == 0) || (length == 3 && std::memcmp(token, "0-1", 3) == 0)
+			|| (length == 7 && std::memcmp(token, "1/2-1/2", 7) == 0) || (length == 1 && token[0] == '*'))
+		{
+			game.result.assign(token, length);
+			return;
+		}
+		// Move numbers, such as "12." or "12...", may run straight into the move after them. Only digits
+		// followed by a dot are a move number, so that castling written with zeros, "0-0", is kept.
+		size_t digits = 0;
+		while (digits < length && token[digits] >= '0' && token[digits] <= '9')
+		{
+			digits++;
+		}
+		if (digits < length && token[digits] == '.')
+		{
+			while (digits < length && token[digits] == '.')
+			{
+				digits++;
+			}
+			token += digits;
+			length -= digits;
+		}
+		if (length == 0 || !game.error.empty())
+		{
+			continue;
+		}
+		Move move = ParseSAN(board_, token, length);
+		if (move == Move())
+		{
+			game.error = "illegal or ambiguous move " + string(token, length) + " after " + std::to_string(game.moves.size()) + " plies";
+			continue;
+		}
+		board_.MakeMove(move);
+		game.moves.push_back(move);
+	}
+}
+
+/**
+ * Reads the next game. Text that is not part of a game, such as blank lines between games, is skipped.
+ *
+ * @param game: Filled in with the game. Check its error to see whether every move could be read.
+ * @return: True if a game was read, false at the end of the text.
+ */
+bool PgnReader::ReadGame(PgnGame& game)
+{
+	game.Clear();
+	SkipSpace();
+	if (position_ >= end_)
+	{
+		return false;
+	}
+	while (position_ < end_ && *position_ == '[')
+	{
+		if (!ReadTag(game) && game.error.empty())
+		{
+			game.error = "malformed tag";
+		}
+		SkipSpace();
+	}
+	if (game.fen.empty())
+	{
+		board_.Reset();
+	}
+	else if (!board_.FromFEN(game.fen.c_str()))
+	{
+		game.error = "could not read the position " + game.fen;
+	}
+	ReadMoves(game);
+	return true;
+}
+
+/**
+ * Writes a game in PGN export format: the tags, then the moves in SAN wrapped to fit the line length,
+ * then the result. The game's moves must be legal from its starting position.
+ *
+ * @param out: Where to write the game
+ * @param game: The game to write
+ * @return: None
+ */
+void WritePgnGame(ostream& out, const PgnGame& game)
+{
+	for (const auto& tag : game.tags)
+	{
+		out << '[' << tag.first << " \"";
+		for (char symbol : tag.second)
+		{
+			if (symbol == '"' || symbol == '\\')
+			{
+				out << '\\';
+			}
+			out << symbol;
+		}
+		out << "\"]\n";
+	}
+	out << '\n';
+
+	ChessBoard chess_board;
+	chess_board.Reset();
+	if (!game.fen.empty())
+	{
+		chess_board.FromFEN(game.fen.c_str());
+	}
+	// Each move is built in a small buffer with its number, so that a line is only broken between moves.
+	size_t line_length = 0;
+	bool first = true;
+	for (Move move : game.moves)
+	{
+		char text[32];
+		char* token = text;
+		if (chess_board.GetSideToMove() == Color::White || first)
+		{
+			token += std::snprintf(token, 16, chess_board.GetSideToMove() == Color::White ? "%d. " : "%d... ", chess_board.GetFullmoveNumber());
+		}
+		token += MoveToSAN(chess_board, move, token);
+		chess_board.MakeMove(move);
+		first = false;
+
+		size_t length = token - text;
+		if (line_length > 0 && line_length + 1 + length > kPgnLineLength)
+		{
+			out << '\n';
+			line_length = 0;
+		}
+		else if (line_length > 0)
+		{
+			out << ' ';
+			line_length++;
+		}
+		out.write(text, length);
+		line_length += length;
+	}
+	if (line_length > 0 && line_length + 1 + game.result.size() > kPgnLineLength)
+	{
+		out << '\n';
+	}
+	else if (line_length > 0)
+	{
+		out << ' ';
+	}
+	out << game.result << "\n\n";
+}
+
+/**
+ * Divides PGN text into roughly equal parts that each hold whole games, so that the parts can be read
+ * on separate threads. Each cut is moved forward to the next line that starts a game's tags with "[Event ".
+ *
+ * @param begin: The start of the text
+ * @param end: The end of the text
+ * @param parts: The number of parts wanted
+ * @return: The parts, in order. There may be fewer than asked for if the games are few and large.
+ */
+vector<pair<const char*, const char*>> SplitPgn(const char* begin, const char* end, int parts)
+{
+	static const char kGameStart[] = "\n[Event ";
+	vector<pair<const char*, const char*>> ranges;
+	const char* part_start = begin;
+	for (int part = 1; part < parts && part_start < end; part++)
+	{
+		const char* cut = begin + (end - begin) / parts * part;
+		if (cut <= part_start)
+		{
+			continue;
+		}
+		const char* found = std::search(cut, end, kGameStart, kGameStart + sizeof(kGameStart) - 1);
+		if (found == end)
+		{
+			break;
+		}
+		ranges.emplace_back(part_start, found + 1);
+		part_start = found + 1;
+	}
+	ranges.emplace_back(part_start, end);
+	return ranges;
+}
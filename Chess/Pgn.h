@@ -0,0 +1,63 @@
+#pragma once
+#include "ChessBoard.h"
+#include "MoveGen.h"
+
+#include <cstddef>
+#include <string>
+using std::string;
+#include <utility>
+using std::pair;
+#include <vector>
+using std::vector;
+
+/**
+ * One game from a PGN file: its tags, the moves from the start position and the result. A PgnGame can be
+ * reused for game after game, which keeps the allocations of its vectors.
+ */
+struct PgnGame
+{
+	// Name and value of each tag, in the order they appear.
+	vector<pair<string, string>> tags;
+	// The starting position from the FEN tag, or empty for the normal start position.
+	string fen;
+	vector<Move> moves;
+	// "1-0", "0-1", "1/2-1/2" or "*".
+	string result = "*";
+	// Why the game could not be read in full, or empty. The moves before the problem are kept.
+	string error;
+
+	void Clear() { tags.clear(); fen.clear(); moves.clear(); result = "*"; error.clear(); }
+	const string* GetTag(const string& name) const;
+};
+
+/**
+ * Reads games one at a time from PGN text in memory, such as a MappedFile. Every move is resolved from
+ * Standard Algebraic Notation against the legal moves of the position, so a game that reads without an
+ * error is a legal game.
+ */
+class PgnReader
+{
+private:
+	const char* position_;
+	const char* end_;
+	ChessBoard board_;
+
+	void SkipSpace();
+	bool ReadTag(PgnGame& game);
+	void ReadMoves(PgnGame& game);
+
+public:
+	PgnReader(const char* begin, const char* end) : position_(begin), end_(end) {}
+
+	bool ReadGame(PgnGame& game);
+	// The final position of the last game read.
+	const ChessBoard& GetBoard() const { return board_; }
+};
+
+Move ParseSAN(const ChessBoard& chess_board, const char* text, size_t length);
+
+int MoveToSAN(ChessBoard& chess_board, Move move, char* buffer);
+
+void WritePgnGame(ostream& out, const PgnGame& game);
+
+vector<pair<const char*, const char*>> SplitPgn(const char* begin, const char* end, int parts);
@@ -0,0 +1,226 @@
+#include "GameArchive.h"
+#include "MappedFile.h"
+#include "Pgn.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <string>
+using std::string;
+#include <thread>
+#include <vector>
+using std::vector;
+
+// Only the first few unreadable games of each part are reported, so a bad archive does not flood the output.
+const int kMaxReportedErrors = 10;
+// The archive is read in parts of about this many bytes, many more than there are threads, so that a thread
+// only ever holds the output of the one part it is reading.
+const size_t kPartBytes = 4 << 20;
+
+/**
+ * What reading one part of an archive found.
+ */
+struct PartResult
+{
+	uint64_t games = 0;
+	uint64_t plies = 0;
+	uint64_t errors = 0;
+	// The first few errors, one per line.
+	string error_text;
+	// The games written back out as PGN, if a PGN output file was asked for.
+	std::ostringstream output;
+	// The part's readable games, kept until its turn to be written to a binary archive, if one was asked for.
+	vector<PgnGame> games_to_archive;
+};
+
+/**
+ * Hands out the parts of an archive to the reading threads in order, and lets a thread write out a part
+ * only once every part before it has been written. The output keeps the games in their order, while no
+ * more than one part per thread is held in memory.
+ */
+class PartQueue
+{
+private:
+	std::mutex mutex_;
+	std::condition_variable written_;
+	size_t part_count_;
+	size_t next_part_ = 0;
+	size_t next_to_write_ = 0;
+
+public:
+	explicit PartQueue(size_t part_count) : part_count_(part_count) {}
+
+	/**
+	 * @param part: Set to the next part to read
+	 * @return: True if there was a part left, false otherwise.
+	 */
+	bool Take(size_t& part)
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		part = next_part_++;
+		return part < part_count_;
+	}
+
+	/**
+	 * Waits until every part before this one has been written.
+	 *
+	 * @param part: The part about to be written
+	 * @return: None
+	 */
+	void WaitForTurn(size_t part)
+	{
+		std::unique_lock<std::mutex> lock(mutex_);
+		written_.wait(lock, [&]() { return next_to_write_ == part; });
+	}
+
+	/**
+	 * Lets the next part be written. Called by the thread whose turn it is once its part is written.
+	 *
+	 * @return: None
+	 */
+	void Written()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			next_to_write_++;
+		}
+		written_.notify_all();
+	}
+};
+
+/**
+ * Reads every game in one part of an archive, checking each move, and optionally writes the games back out.
+ *
+ * @param begin: The start of the part
+ * @param end: The end of the part
+ * @param write_games: Whether to write the games to the result's output
+ * @param archive_games: Whether to keep the games for a binary archive
+ * @param result: Filled in with what was found, which must start out empty
+ * @return: None
+ */
+static void ReadPart(const char* begin, const char* end, bool write_games, bool archive_games, PartResult& result)
+{
+	PgnReader reader(begin, end);
+	PgnGame game;
+	while (reader.ReadGame(game))
+	{
+		result.games++;
+		result.plies += game.moves.size();
+		if (!game.error.empty())
+		{
+			if (result.errors++ < kMaxReportedErrors)
+			{
+				const string* white = game.GetTag("White");
+				const string* black = game.GetTag("Black");
+				result.error_text += (white ? *white : "?") + " - " + (black ? *black : "?") + ": " + game.error + "\n";
+			}
+		}
+		if (write_games)
+		{
+			WritePgnGame(result.output, game);
+		}
+		if (archive_games && game.error.empty())
+		{
+			result.games_to_archive.push_back(game);
+		}
+	}
+}
+
+/**
+ * Reads a PGN archive and checks that every move of every game is legal. The file is mapped into memory
+ * rather than read, and split into parts at game boundaries so that several threads can read it at once.
+ * The games can be written back out in standard export format, which also normalizes their notation, or
+ * to a binary archive (see GameArchive.h) if the output file ends in ".bin". Adding "hashes" stores the hash
+ * of every position in the archive too.
+ *
+ * Usage:
+ *   pgn <file> [threads] [output file] [hashes]
+ *
+ * @return: 0 if every game was read, 1 otherwise.
+ */
+int main(int argc, char* argv[])
+{
+	if (argc < 2)
+	{
+		cout << "Usage: pgn <file> [threads] [output file] [hashes]" << endl;
+		return 1;
+	}
+	int thread_count = argc >= 3 ? std::atoi(argv[2]) : static_cast<int>(std::thread::hardware_concurrency());
+	if (thread_count < 1)
+	{
+		thread_count = 1;
+	}
+	string output_path = argc >= 4 ? argv[3] : "";
+	bool archive_games = output_path.size() > 4 && output_path.compare(output_path.size() - 4, 4, ".bin") == 0;
+	bool write_games = !output_path.empty() && !archive_games;
+
+	MappedFile file;
+	if (!file.Open(argv[1]))
+	{
+		cout << "Could not open " << argv[1] << endl;
+		return 1;
+	}
+	std::ofstream output;
+	if (write_games)
+	{
+		output.open(output_path, std::ios::binary);
+	}
+	GameArchiveWriter writer;
+	bool archive_written = !archive_games || writer.Open(output_path, argc >= 5 && string(argv[4]) == "hashes");
+	auto start = std::chrono::steady_clock::now();
+	size_t part_count = file.GetSize() / kPartBytes + 1;
+	auto parts = SplitPgn(file.begin(), file.end(), static_cast<int>(std::max<size_t>(part_count, thread_count)));
+	PartQueue queue(parts.size());
+	PartResult total;
+	auto worker = [&]()
+	{
+		size_t part;
+		while (queue.Take(part))
+		{
+			PartResult result;
+			ReadPart(parts[part].first, parts[part].second, write_games, archive_games, result);
+			// Each part is written out as soon as the parts before it have been, so only the parts being
+			// read are ever held in memory.
+			queue.WaitForTurn(part);
+			cout << result.error_text;
+			if (write_games)
+			{
+				output << result.output.str();
+			}
+			for (const PgnGame& game : result.games_to_archive)
+			{
+				archive_written = archive_written && writer.WriteGame(game);
+			}
+			// Only the thread whose turn it is adds to the totals.
+			total.games += result.games;
+			total.plies += result.plies;
+			total.errors += result.errors;
+			queue.Written();
+		}
+	};
+	vector<std::thread> workers;
+	for (int i = 0; i < thread_count && i < static_cast<int>(parts.size()); i++)
+	{
+		workers.emplace_back(worker);
+	}
+	for (std::thread& thread : workers)
+	{
+		thread.join();
+	}
+	double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	if ((archive_games && (!writer.Close() || !archive_written)) || (write_games && !output))
+	{
+		cout << "Could not write " << output_path << endl;
+		return 1;
+	}
+	cout << total.games << " games, " << total.plies << " plies, " << total.errors << " with errors, read on "
+		<< workers.size() << " threads in " << elapsed << " s, "
+		<< static_cast<uint64_t>(total.games * 60 / (elapsed > 0 ? elapsed : 1e-9)) << " games/minute" << endl;
+	return total.errors == 0 ? 0 : 1;
+}
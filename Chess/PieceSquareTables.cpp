@@ -0,0 +1,139 @@
+#include "PieceSquareTables.h"
+
+// What each piece is worth on its own, indexed by Piece. Pawns gain value as the board empties and they
+// come closer to promoting, while the minor pieces lose a little.
+static constexpr array<Score, 7> kMaterial = {
+	Score(0, 0), Score(100, 120), Score(320, 300), Score(330, 320), Score(500, 520), Score(900, 940), Score(0, 0)
+};
+
+// The tables below are for white and are laid out the way the board is printed, so the first row is rank 8.
+// Black's pieces use the same tables turned upside down.
+using SquareTable = array<int, 64>;
+
+static constexpr SquareTable kPawnMiddlegame = {
+	  0,   0,   0,   0,   0,   0,   0,   0,
+	 50,  50,  50,  50,  50,  50,  50,  50,
+	 10,  10,  20,  30,  30,  20,  10,  10,
+	  5,   5,  10,  25,  25,  10,   5,   5,
+	  0,   0,   0,  20,  20,   0,   0,   0,
+	  5,  -5, -10,   0,   0, -10,  -5,   5,
+	  5,  10,  10, -20, -20,  10,  10,   5,
+	  0,   0,   0,   0,   0,   0,   0,   0,
+};
+
+// In the endgame a pawn is worth more the closer it is to promoting, wherever it is across the board.
+static constexpr SquareTable kPawnEndgame = {
+	  0,   0,   0,   0,   0,   0,   0,   0,
+	 80,  80,  80,  80,  80,  80,  80,  80,
+	 50,  50,  50,  50,  50,  50,  50,  50,
+	 30,  30,  30,  30,  30,  30,  30,  30,
+	 15,  15,  15,  15,  15,  15,  15,  15,
+	  5,   5,   5,   5,   5,   5,   5,   5,
+	  0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,
+};
+
+static constexpr SquareTable kKnight = {
+	-50, -40, -30, -30, -30, -30, -40, -50,
+	-40, -20,   0,   0,   0,   0, -20, -40,
+	-30,   0,  10,  15,  15,  10,   0, -30,
+	-30,   5,  15,  20,  20,  15,   5, -30,
+	-30,   0,  15,  20,  20,  15,   0, -30,
+	-30,   5,  10,  15,  15,  10,   5, -30,
+	-40, -20,   0,   5,   5,   0, -20, -40,
+	-50, -40, -30, -30, -30, -30, -40, -50,
+};
+
+static constexpr SquareTable kBishop = {
+	-20, -10, -10, -10, -10, -10, -10, -20,
+	-10,   0,   0,   0,   0,   0,   0, -10,
+	-10,   0,   5,  10,  10,   5,   0, -10,
+	-10,   5,   5,  10,  10,   5,   5, -10,
+	-10,   0,  10,  10,  10,  10,   0, -10,
+	-10,  10,  10,  10,  10,  10,  10, -10,
+	-10,   5,   0,   0,   0,   0,   5, -10,
+	-20, -10, -10, -10, -10, -10, -10, -20,
+};
+
+static constexpr SquareTable kRookMiddlegame = {
+	  0,   0,   0,   0,   0,   0,   0,   0,
+	  5,  10,  10,  10,  10,  10,  10,   5,
+	 -5,   0,   0,   0,   0,   0,   0,  -5,
+	 -5,   0,   0,   0,   0,   0,   0,  -5,
+	 -5,   0,   0,   0,   0,   0,   0,  -5,
+	 -5,   0,   0,   0,   0,   0,   0,  -5,
+	 -5,   0,   0,   0,   0,   0,   0,  -5,
+	  0,   0,   0,   5,   5,   0,   0,   0,
+};
+
+// Rooks are as good anywhere in the endgame, apart from cutting off the enemy king on the seventh rank.
+static constexpr SquareTable kRookEndgame = {
+	  0,   0,   0,   0,   0,   0,   0,   0,
+	 10,  10,  10,  10,  10,  10,  10,  10,
+	  0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,
+};
+
+static constexpr SquareTable kQueen = {
+	-20, -10, -10,  -5,  -5, -10, -10, -20,
+	-10,   0,   0,   0,   0,   0,   0, -10,
+	-10,   0,   5,   5,   5,   5,   0, -10,
+	 -5,   0,   5,   5,   5,   5,   0,  -5,
+	  0,   0,   5,   5,   5,   5,   0,  -5,
+	-10,   5,   5,   5,   5,   5,   0, -10,
+	-10,   0,   5,   0,   0,   0,   0, -10,
+	-20, -10, -10,  -5,  -5, -10, -10, -20,
+};
+
+// The king hides behind its pawns while there are pieces to attack it...
+static constexpr SquareTable kKingMiddlegame = {
+	-30, -40, -40, -50, -50, -40, -40, -30,
+	-30, -40, -40, -50, -50, -40, -40, -30,
+	-30, -40, -40, -50, -50, -40, -40, -30,
+	-30, -40, -40, -50, -50, -40, -40, -30,
+	-20, -30, -30, -40, -40, -30, -30, -20,
+	-10, -20, -20, -20, -20, -20, -20, -10,
+	 20,  20,   0,   0,   0,   0,  20,  20,
+	 20,  30,  10,   0,   0,  10,  30,  20,
+};
+
+// ...and comes out to the center to fight once they are gone.
+static constexpr SquareTable kKingEndgame = {
+	-50, -40, -30, -20, -20, -30, -40, -50,
+	-30, -20, -10,   0,   0, -10, -20, -30,
+	-30, -10,  20,  30,  30,  20, -10, -30,
+	-30, -10,  30,  40,  40,  30, -10, -30,
+	-30, -10,  30,  40,  40,  30, -10, -30,
+	-30, -10,  20,  30,  30,  20, -10, -30,
+	-30, -30,   0,   0,   0,   0, -30, -30,
+	-50, -30, -30, -30, -30, -30, -30, -50,
+};
+
+/**
+ * Adds each piece's material to its placement tables, for both colors.
+ *
+ * @return: The filled in scores.
+ */
+static constexpr array<array<array<Score, 64>, 7>, 2> MakePieceSquareScores()
+{
+	const SquareTable* middlegame[7] = { nullptr, &kPawnMiddlegame, &kKnight, &kBishop, &kRookMiddlegame, &kQueen, &kKingMiddlegame };
+	const SquareTable* endgame[7] = { nullptr, &kPawnEndgame, &kKnight, &kBishop, &kRookEndgame, &kQueen, &kKingEndgame };
+	array<array<array<Score, 64>, 7>, 2> scores{};
+	for (int piece = static_cast<int>(Piece::Pawn); piece <= static_cast<int>(Piece::King); piece++)
+	{
+		for (int square = 0; square < 64; square++)
+		{
+			Score score = kMaterial[piece] + Score((*middlegame[piece])[square], (*endgame[piece])[square]);
+			scores[ColorIndex(Color::White)][piece][square] = score;
+			// Flipping the rank turns black's square into the matching square from white's side.
+			scores[ColorIndex(Color::Black)][piece][square ^ 56] = -score;
+		}
+	}
+	return scores;
+}
+
+constexpr array<array<array<Score, 64>, 7>, 2> kPieceSquareScores = MakePieceSquareScores();
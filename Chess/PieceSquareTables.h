@@ -0,0 +1,46 @@
+#pragma once
+#include "ChessPiece.h"
+
+#include <array>
+using std::array;
+
+/**
+ * A pair of scores in hundredths of a pawn, one for the middlegame and one for the endgame. The evaluation
+ * blends the two by how much material is left (see kPhaseWeights), so what a piece is worth on a square
+ * shifts smoothly as pieces come off the board.
+ */
+struct Score
+{
+	int mg = 0;
+	int eg = 0;
+
+	constexpr Score() = default;
+	constexpr Score(int middlegame, int endgame) : mg(middlegame), eg(endgame) {}
+
+	constexpr Score& operator+=(Score other) { mg += other.mg; eg += other.eg; return *this; }
+	constexpr Score& operator-=(Score other) { mg -= other.mg; eg -= other.eg; return *this; }
+};
+
+constexpr Score operator+(Score left, Score right) { return Score(left.mg + right.mg, left.eg + right.eg); }
+constexpr Score operator-(Score left, Score right) { return Score(left.mg - right.mg, left.eg - right.eg); }
+constexpr Score operator-(Score score) { return Score(-score.mg, -score.eg); }
+constexpr Score operator*(Score score, int factor) { return Score(score.mg * factor, score.eg * factor); }
+
+// How much each piece counts towards the middlegame, indexed by Piece. The phase is kMaxPhase with every
+// piece on the board and 0 once only kings and pawns are left.
+const array<int, 7> kPhaseWeights = { 0, 0, 1, 1, 2, 4, 0 };
+const int kMaxPhase = 24;
+
+/**
+ * The material and placement score of every piece on every square, from white's point of view, so black's
+ * pieces score negatively. A position's score is the sum over its pieces, so placing or removing a piece only
+ * adds or takes away its own entry, and the board keeps the total up to date as moves are made and unmade.
+ *
+ * Indexed by ColorIndex, then Piece, then square.
+ */
+extern const array<array<array<Score, 64>, 7>, 2> kPieceSquareScores;
+
+inline Score PieceSquareScore(Color color, Piece piece, int square)
+{
+	return kPieceSquareScores[ColorIndex(color)][static_cast<int>(piece)][square];
+}
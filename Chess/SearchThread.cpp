@@ -0,0 +1,418 @@
+#include "SearchThread.h"
+#include "Evaluation.h"
+#include "Instrumentation.h"
+
+/**
+ * Mate scores count the moves from the root, but the table is shared between positions reached at
+ * different distances from the root. Mate scores are stored counting from the position itself instead.
+ *
+ * @param score: The score as returned by the search
+ * @param ply: The distance of the position from the root
+ * @return: The score to store in the transposition table.
+ */
+static int ScoreToTable(int score, int ply)
+{
+	if (score >= kMateScore - kMaxSearchDepth * 2)
+	{
+		return score + ply;
+	}
+	if (score <= -kMateScore + kMaxSearchDepth * 2)
+	{
+		return score - ply;
+	}
+	return score;
+}
+
+/**
+ * The reverse of ScoreToTable.
+ *
+ * @param score: The score read from the transposition table
+ * @param ply: The distance of the position from the root
+ * @return: The score as the search uses it.
+ */
+static int ScoreFromTable(int score, int ply)
+{
+	if (score >= kMateScore - kMaxSearchDepth * 2)
+	{
+		return score - ply;
+	}
+	if (score <= -kMateScore + kMaxSearchDepth * 2)
+	{
+		return score + ply;
+	}
+	return score;
+}
+
+/**
+ * Turns what a tablebase knows into a search score. Wins are scored as mates when the mate is close
+ * enough to the root to be told apart from the search's own mate scores, and just below them otherwise.
+ *
+ * @param probe: The tablebase result for the position, which must have been found
+ * @param ply: The distance of the position from the root
+ * @return: The score of the position from the point of view of the side to move.
+ */
+int TablebaseScore(const TablebaseProbe& probe, int ply)
+{
+	if (probe.result == TablebaseResult::Draw)
+	{
+		return 0;
+	}
+	int distance = ply + probe.distance;
+	int score = distance <= kMaxSearchDepth * 2 ? kMateScore - distance : kTablebaseWinScore - distance;
+	return probe.result == TablebaseResult::Win ? score : -score;
+}
+
+/**
+ * @return: True if the move captures a piece, including en passant.
+ */
+static bool IsCapture(const ChessBoard& chess_board, Move move)
+{
+	return chess_board.GetPieceAt(move.GetEnd()).GetPiece() != Piece::Empty || move.GetType() == MoveType::EnPassant;
+}
+
+/**
+ * Gives each move a rough score so that the moves most likely to be best are searched first, which lets
+ * alpha-beta cut off more of the tree. Captures are ordered by most valuable victim, least valuable attacker,
+ * then come the killer moves of this ply and then the other quiet moves by their history. Only the root moves
+ * are scored this way, since every one of them is searched on each iteration; other nodes use a MovePicker.
+ *
+ * @param move: The move to score
+ * @param best_move: A move already known to be good, such as the transposition table move
+ * @param ply: The distance from the root of the search
+ * @return: A higher number for moves that should be tried earlier.
+ */
+int SearchThread::ScoreMove(Move move, Move best_move, int ply) const
+{
+	if (move == best_move)
+	{
+		return 1000000;
+	}
+	int score = 0;
+	const ChessPiece& victim = board_.GetPieceAt(move.GetEnd());
+	if (victim.GetPiece() != Piece::Empty)
+	{
+		score += 10 * kPieceValues[static_cast<int>(victim.GetPiece())] - kPieceValues[static_cast<int>(board_.GetPieceAt(move.GetStart()).GetPiece())];
+	}
+	if (move.GetType() == MoveType::Promotion)
+	{
+		score += kPieceValues[static_cast<int>(move.GetPromotion())];
+	}
+	if (score != 0 || move.GetType() == MoveType::EnPassant)
+	{
+		return score + 100000;
+	}
+	if (move == stack_[ply].killers[0])
+	{
+		return kMaxHistory + 2;
+	}
+	if (move == stack_[ply].killers[1])
+	{
+		return kMaxHistory + 1;
+	}
+	return history_[ColorIndex(board_.GetSideToMove())][move.GetStart()][move.GetEnd()];
+}
+
+/**
+ * Sorts a move list so that the highest scoring moves come first.
+ *
+ * @param move_list: The moves to sort
+ * @param best_move: A move to put first if it is in the list
+ * @param ply: The distance from the root of the search
+ * @return: None
+ */
+void SearchThread::OrderMoves(MoveList& move_list, Move best_move, int ply) const
+{
+	array<int, 256> scores;
+	for (int i = 0; i < move_list.Size(); i++)
+	{
+		scores[i] = ScoreMove(move_list[i], best_move, ply);
+	}
+	// Insertion sort: the lists are short and often nearly in order already.
+	for (int i = 1; i < move_list.Size(); i++)
+	{
+		Move move = move_list[i];
+		int score = scores[i];
+		int j = i - 1;
+		for (; j >= 0 && scores[j] < score; j--)
+		{
+			move_list[j + 1] = move_list[j];
+			scores[j + 1] = scores[j];
+		}
+		move_list[j + 1] = move;
+		scores[j + 1] = score;
+	}
+}
+
+/**
+ * Records that a quiet move caused a beta cutoff, so that it is tried earlier next time.
+ *
+ * @param move: The move that caused the cutoff
+ * @param depth: The depth it was searched to. Cutoffs deeper in the tree save more work, so they count for more.
+ * @param ply: The distance from the root of the search
+ * @return: None
+ */
+void SearchThread::UpdateQuietMove(Move move, int depth, int ply)
+{
+	if (stack_[ply].killers[0] != move)
+	{
+		stack_[ply].killers[1] = stack_[ply].killers[0];
+		stack_[ply].killers[0] = move;
+	}
+	// Each update moves the score part of the way towards the maximum, so it never goes past it.
+	int& history = history_[ColorIndex(board_.GetSideToMove())][move.GetStart()][move.GetEnd()];
+	int bonus = depth * depth < kMaxHistory ? depth * depth : kMaxHistory;
+	history += bonus - history * bonus / kMaxHistory;
+}
+
+/**
+ * Counts a node and checks whether the search should stop. Only the first thread keeps time; it stops every thread once the
+ * time budget has been used up. The clock is read every few thousand nodes, which keeps the overshoot
+ * well under a millisecond.
+ *
+ * @return: True if the search should stop.
+ */
+bool SearchThread::ShouldStop()
+{
+	++nodes_;
+	if (id_ == 0 && (nodes_ & 2047) == 0 && limits_.move_time_ms > 0)
+	{
+		auto elapsed = std::chrono::steady_clock::now() - search_start_;
+		if (std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count() >= limits_.move_time_ms)
+		{
+			stop_.store(true, std::memory_order_relaxed);
+		}
+	}
+	return stop_.load(std::memory_order_relaxed);
+}
+
+/**
+ * Searches only captures and promotions until the position is quiet, so that the static evaluation is never
+ * taken in the middle of an exchange. The side to move may always "stand pat" and decline to capture.
+ *
+ * @param alpha: The score the side to move is already guaranteed
+ * @param beta: The score the opponent is already guaranteed, negated
+ * @param ply: The distance from the root of the search
+ * @return: The score of the position from the point of view of the side to move.
+ */
+int SearchThread::Quiescence(int alpha, int beta, int ply)
+{
+	CHESS_COUNTED_PROBE(QuiescenceNode);
+	if (ShouldStop())
+	{
+		return 0;
+	}
+
+	int stand_pat = Evaluate(board_);
+	if (stand_pat >= beta || ply >= kMaxSearchDepth * 2)
+	{
+		return stand_pat;
+	}
+	if (stand_pat > alpha)
+	{
+		alpha = stand_pat;
+	}
+
+	MovePicker move_picker(board_);
+	for (Move move = move_picker.Next(); move != Move(); move = move_picker.Next())
+	{
+		board_.MakeMove(move);
+		int score = -Quiescence(-beta, -alpha, ply + 1);
+		board_.UnmakeMove();
+		if (stop_.load(std::memory_order_relaxed))
+		{
+			return 0;
+		}
+		if (score >= beta)
+		{
+			return score;
+		}
+		if (score > alpha)
+		{
+			alpha = score;
+		}
+	}
+	return alpha;
+}
+
+/**
+ * Negamax search with alpha-beta pruning. Each side's score is the negation of the other's, so one function
+ * searches for both players.
+ *
+ * @param depth: The number of moves left to search before dropping into the quiescence search
+ * @param alpha: The score the side to move is already guaranteed
+ * @param beta: The score the opponent is already guaranteed, negated
+ * @param ply: The distance from the root of the search
+ * @return: The score of the position from the point of view of the side to move.
+ */
+int SearchThread::Search(int depth, int alpha, int beta, int ply)
+{
+	if (depth <= 0)
+	{
+		return Quiescence(alpha, beta, ply);
+	}
+	CHESS_COUNTED_PROBE(SearchNode);
+	if (ShouldStop())
+	{
+		return 0;
+	}
+	if (board_.IsRepetition() || board_.GetHalfmoveClock() >= 100)
+	{
+		return 0;
+	}
+
+	// Once few enough pieces are left a tablebase knows the exact result, so there is nothing to search.
+	if (PopCount(board_.GetOccupied()) <= tablebases_.GetMaxPieces())
+	{
+		TablebaseProbe probe = tablebases_.Probe(board_);
+		if (probe.result != TablebaseResult::NotFound)
+		{
+			return TablebaseScore(probe, ply);
+		}
+	}
+
+	// A previous search of this position may already answer the question, or at least suggest a good move to try first.
+	TTData tt_data;
+	bool tt_hit = transposition_table_.Probe(board_.GetHash(), tt_data);
+	if (tt_hit && tt_data.depth >= depth)
+	{
+		int tt_score = ScoreFromTable(tt_data.score, ply);
+		if (tt_data.bound == Bound::Exact
+			|| (tt_data.bound == Bound::Lower && tt_score >= beta)
+			|| (tt_data.bound == Bound::Upper && tt_score <= alpha))
+		{
+			return tt_score;
+		}
+	}
+
+	// The killers of the next ply are only useful for siblings of this position.
+	stack_[ply + 1].killers = {};
+
+	int original_alpha = alpha;
+	int best_score = -kInfinityScore;
+	Move best_move;
+	int move_count = 0;
+	MovePicker move_picker(board_, tt_hit ? tt_data.move : Move(), stack_[ply].killers, history_);
+	for (Move move = move_picker.Next(); move != Move(); move = move_picker.Next())
+	{
+		move_count++;
+		board_.MakeMove(move);
+		int score = -Search(depth - 1, -beta, -alpha, ply + 1);
+		board_.UnmakeMove();
+		if (stop_.load(std::memory_order_relaxed))
+		{
+			return 0;
+		}
+		if (score > best_score)
+		{
+			best_score = score;
+			best_move = move;
+		}
+		if (score > alpha)
+		{
+			alpha = score;
+		}
+		if (alpha >= beta)
+		{
+			if (!IsCapture(board_, move) && move.GetType() != MoveType::Promotion)
+			{
+				UpdateQuietMove(move, depth, ply);
+			}
+			break;
+		}
+	}
+	if (move_count == 0)
+	{
+		// Checkmate is scored so that a quicker mate is better, or stalemate is a draw.
+		return IsInCheck(board_) ? -kMateScore + ply : 0;
+	}
+
+	Bound bound = best_score >= beta ? Bound::Lower : best_score > original_alpha ? Bound::Exact : Bound::Upper;
+	// When every move failed low none of them is known to be best.
+	transposition_table_.Store(board_.GetHash(), bound == Bound::Upper ? Move() : best_move, ScoreToTable(best_score, ply), depth, bound);
+	return best_score;
+}
+
+/**
+ * Searches a position with iterative deepening: one move deep, then two, and so on until a limit is
+ * reached or another thread stops the search. If the search stops part way through an iteration, the
+ * result of the last completed iteration is kept. Helper threads with odd ids start one move deeper,
+ * so that the threads spread out over the depths instead of all searching the same tree.
+ *
+ * @param chess_board: The position to search. The thread searches its own copy.
+ * @param limits: How long and how deep to search
+ * @param search_start: When the search started, which the time budget counts from
+ * @return: None
+ */
+void SearchThread::Run(const ChessBoard& chess_board, const SearchLimits& limits, std::chrono::steady_clock::time_point search_start)
+{
+	board_ = chess_board;
+	limits_ = limits;
+	search_start_ = search_start;
+	nodes_ = 0;
+	result_ = SearchResult();
+	stack_ = {};
+	// Older history is worth less than what this search finds.
+	for (auto& starts : history_)
+	{
+		for (auto& ends : starts)
+		{
+			for (int& history : ends)
+			{
+				history /= 2;
+			}
+		}
+	}
+
+	MoveList root_moves;
+	GenerateLegalMoves(board_, root_moves);
+	if (root_moves.Size() > 0)
+	{
+		result_.best_move = root_moves[0];
+	}
+
+	int first_depth = id_ % 2 == 0 ? 1 : 2;
+	for (int depth = first_depth; root_moves.Size() > 0 && depth <= limits.max_depth && depth <= kMaxSearchDepth; depth++)
+	{
+		// The previous iteration's best move is searched first, which makes the most of alpha-beta.
+		OrderMoves(root_moves, result_.best_move, 0);
+		int alpha = -kInfinityScore;
+		Move best_move = root_moves[0];
+		for (Move move : root_moves)
+		{
+			board_.MakeMove(move);
+			int score = -Search(depth - 1, -kInfinityScore, -alpha, 1);
+			board_.UnmakeMove();
+			if (stop_.load(std::memory_order_relaxed))
+			{
+				break;
+			}
+			if (score > alpha)
+			{
+				alpha = score;
+				best_move = move;
+			}
+		}
+		if (stop_.load(std::memory_order_relaxed))
+		{
+			break;
+		}
+		result_.best_move = best_move;
+		result_.score = alpha;
+		result_.depth = depth;
+		transposition_table_.Store(board_.GetHash(), best_move, ScoreToTable(alpha, 0), depth, Bound::Exact);
+
+		// There is no point searching deeper once a forced mate has been found, or when only one move is possible.
+		if (alpha >= kMateScore - kMaxSearchDepth || alpha <= -kMateScore + kMaxSearchDepth || root_moves.Size() == 1)
+		{
+			break;
+		}
+	}
+
+	result_.nodes = nodes_;
+	result_.time_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - search_start_).count();
+	// The first thread decides when the search is over.
+	if (id_ == 0)
+	{
+		stop_.store(true, std::memory_order_relaxed);
+	}
+}
@@ -0,0 +1,98 @@
+#pragma once
+#include "ChessBoard.h"
+#include "MoveGen.h"
+#include "MovePicker.h"
+#include "Tablebase.h"
+#include "TranspositionTable.h"
+
+#include <array>
+using std::array;
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// Scores at or beyond this magnitude (less the distance to mate) mean a forced checkmate.
+const int kMateScore = 32000;
+const int kInfinityScore = 32001;
+const int kMaxSearchDepth = 64;
+// Positions a tablebase knows are won, but too far from mate for a mate score, score this less the distance to mate.
+const int kTablebaseWinScore = 20000;
+static_assert(kMaxNetworkScore < kTablebaseWinScore - 256, "A network score must never be taken for a tablebase win");
+// History scores are kept below this, so that they always sort beneath captures and killer moves.
+const int kMaxHistory = 8000;
+
+/**
+ * Limits on how long the computer player may think about a move. The search stops at whichever limit is hit first.
+ */
+struct SearchLimits
+{
+	// The hard time budget for the move in milliseconds, or 0 for no time limit.
+	int64_t move_time_ms = 0;
+	// The deepest iteration to search.
+	int max_depth = kMaxSearchDepth;
+};
+
+/**
+ * What the computer player found: the move to play and the result of the deepest completed iteration.
+ */
+struct SearchResult
+{
+	// Empty (all zero) if the side to move has no legal moves.
+	Move best_move;
+	int score = 0;
+	int depth = 0;
+	uint64_t nodes = 0;
+	int64_t time_ms = 0;
+};
+
+/**
+ * What the search remembers about each ply of the line it is currently searching.
+ */
+struct SearchStackEntry
+{
+	// Quiet moves that recently caused a beta cutoff at this ply. They often refute sibling positions too.
+	array<Move, 2> killers;
+};
+
+int TablebaseScore(const TablebaseProbe& probe, int ply);
+
+/**
+ * One thread of the search. Every thread searches the same position on its own copy of the board, with
+ * its own move ordering statistics, and they share what they find through the transposition table. The
+ * threads reach different parts of the tree first (Lazy SMP), so together they reach a given depth sooner.
+ */
+class SearchThread
+{
+private:
+	int id_;
+	ChessBoard board_;
+	TranspositionTable& transposition_table_;
+	const Tablebases& tablebases_;
+	std::atomic<bool>& stop_;
+
+	std::chrono::steady_clock::time_point search_start_;
+	SearchLimits limits_;
+	uint64_t nodes_ = 0;
+	SearchResult result_;
+
+	HistoryTable history_{};
+	array<SearchStackEntry, kMaxSearchDepth * 2 + 1> stack_{};
+
+	int Search(int depth, int alpha, int beta, int ply);
+	int Quiescence(int alpha, int beta, int ply);
+	int ScoreMove(Move move, Move best_move, int ply) const;
+	void OrderMoves(MoveList& move_list, Move best_move, int ply) const;
+	void UpdateQuietMove(Move move, int depth, int ply);
+	bool ShouldStop();
+
+public:
+	SearchThread(int id, TranspositionTable& transposition_table, const Tablebases& tablebases, std::atomic<bool>& stop)
+		: id_(id), transposition_table_(transposition_table), tablebases_(tablebases), stop_(stop) {}
+
+	void Run(const ChessBoard& chess_board, const SearchLimits& limits, std::chrono::steady_clock::time_point search_start);
+
+	// Forgets the move ordering statistics of earlier searches.
+	void ClearHistory() { history_ = {}; }
+	int GetId() const { return id_; }
+	const SearchResult& GetResult() const { return result_; }
+};
@@ -0,0 +1,216 @@
+#include "ChessGame.h"
+#include "GameArchive.h"
+#include "Pgn.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+using std::string;
+#include <thread>
+#include <vector>
+using std::vector;
+
+// Games are drawn if they reach this length, so that a pair of random players cannot run forever.
+const int kMaxGamePlies = 400;
+// Engine games open with this many random moves, so that a deterministic search still plays varied games.
+const int kRandomOpeningPlies = 8;
+// Each worker's transposition table. Self-play searches are short, so a small table is enough.
+const size_t kSelfPlayHashMB = 4;
+
+/**
+ * The ways a self-play game can end.
+ */
+enum class GameResult { WhiteWins, BlackWins, Draw };
+
+/**
+ * Counts how many times the current position has occurred in the game, including now.
+ *
+ * @param chess_board: The game so far
+ * @return: The number of times the position has occurred.
+ */
+static int CountRepetitions(const ChessBoard& chess_board)
+{
+	const vector<UndoRecord>& history = chess_board.GetHistory();
+	int history_size = static_cast<int>(history.size());
+	int reversible_plies = chess_board.GetHalfmoveClock() < history_size ? chess_board.GetHalfmoveClock() : history_size;
+	int count = 1;
+	for (int plies_back = 2; plies_back <= reversible_plies; plies_back += 2)
+	{
+		count += history[history_size - plies_back].hash == chess_board.GetHash();
+	}
+	return count;
+}
+
+/**
+ * @return: True if neither side has enough material left to checkmate: bare kings, or a king and one minor piece against a king.
+ */
+static bool IsInsufficientMaterial(const ChessBoard& chess_board)
+{
+	if (chess_board.GetPieces(Piece::Pawn) | chess_board.GetPieces(Piece::Rook) | chess_board.GetPieces(Piece::Queen))
+	{
+		return false;
+	}
+	return PopCount(chess_board.GetPieces(Piece::Knight) | chess_board.GetPieces(Piece::Bishop)) <= 1;
+}
+
+/**
+ * Plays one game against itself from the start position.
+ *
+ * @param game: The game to play in, which supplies the engine
+ * @param depth: The depth the engine searches each move to, or 0 to play random moves throughout
+ * @param random: The source of random moves
+ * @param moves: Filled with the moves of the game
+ * @return: The result of the game.
+ */
+static GameResult PlayGame(ChessGame& game, int depth, std::mt19937_64& random, vector<Move>& moves)
+{
+	ChessBoard& chess_board = game.GetBoard();
+	chess_board.Reset();
+	game.NewGame();
+	moves.clear();
+	SearchLimits limits;
+	limits.max_depth = depth;
+
+	for (int ply = 0; ply < kMaxGamePlies; ply++)
+	{
+		MoveList move_list;
+		GenerateLegalMoves(chess_board, move_list);
+		if (move_list.Size() == 0)
+		{
+			if (!IsInCheck(chess_board))
+			{
+				return GameResult::Draw;
+			}
+			return chess_board.GetSideToMove() == Color::White ? GameResult::BlackWins : GameResult::WhiteWins;
+		}
+		if (chess_board.GetHalfmoveClock() >= 100 || CountRepetitions(chess_board) >= 3 || IsInsufficientMaterial(chess_board))
+		{
+			break;
+		}
+
+		Move move;
+		if (depth == 0 || ply < kRandomOpeningPlies)
+		{
+			move = move_list[static_cast<int>(random() % move_list.Size())];
+		}
+		else
+		{
+			move = game.FindBestMove(limits).best_move;
+		}
+		moves.push_back(move);
+		chess_board.MakeMove(move);
+	}
+	return GameResult::Draw;
+}
+
+/**
+ * Plays many games at once without any input, for generating training and regression data. Each worker
+ * thread takes the next game number from a shared counter and plays it with its own engine, so the threads
+ * form a simple pool. Finished games are written to the output file in PGN, or to a binary archive
+ * (see GameArchive.h) if the file name ends in ".bin". Games are seeded by their number, so a run with the same arguments plays the same games.
+ *
+ * Usage:
+ *   selfplay [games] [threads] [output file] [depth]
+ *
+ * A depth of 0 plays random moves throughout instead of searching.
+ *
+ * @return: 0 if every game was written, 1 otherwise.
+ */
+int main(int argc, char* argv[])
+{
+	int game_count = argc >= 2 ? std::atoi(argv[1]) : 1000;
+	int thread_count = argc >= 3 ? std::atoi(argv[2]) : static_cast<int>(std::thread::hardware_concurrency());
+	string output_path = argc >= 4 ? argv[3] : "games.pgn";
+	int depth = argc >= 5 ? std::atoi(argv[4]) : 3;
+	if (thread_count < 1)
+	{
+		thread_count = 1;
+	}
+	if (depth < 0 || depth > kMaxSearchDepth)
+	{
+		depth = 3;
+	}
+
+	bool binary = output_path.size() > 4 && output_path.compare(output_path.size() - 4, 4, ".bin") == 0;
+	std::ofstream output;
+	GameArchiveWriter archive;
+	bool opened;
+	if (binary)
+	{
+		opened = archive.Open(output_path, false);
+	}
+	else
+	{
+		output.open(output_path, std::ios::binary);
+		opened = output.is_open();
+	}
+	if (!opened)
+	{
+		cout << "Could not open " << output_path << endl;
+		return 1;
+	}
+	std::mutex output_mutex;
+	std::atomic<int> next_game{ 0 };
+	std::atomic<int> finished_games{ 0 };
+	array<std::atomic<int>, 3> results{};
+	auto start = std::chrono::steady_clock::now();
+
+	auto worker = [&]()
+	{
+		ChessGame game;
+		game.SetHashSize(kSelfPlayHashMB);
+		PgnGame pgn_game;
+		std::ostringstream pgn_text;
+		for (int game_number = next_game++; game_number < game_count; game_number = next_game++)
+		{
+			std::mt19937_64 random(static_cast<uint64_t>(game_number));
+			GameResult result = PlayGame(game, depth, random, pgn_game.moves);
+			results[static_cast<int>(result)]++;
+			pgn_game.result = result == GameResult::WhiteWins ? "1-0" : result == GameResult::BlackWins ? "0-1" : "1/2-1/2";
+			pgn_game.tags = { { "Event", "Self-play" }, { "Site", "?" }, { "Date", "????.??.??" }, { "Round", std::to_string(game_number + 1) },
+				{ "White", "Chess" }, { "Black", "Chess" }, { "Result", pgn_game.result } };
+			if (binary)
+			{
+				// The board's history holds the game's moves.
+				std::lock_guard<std::mutex> lock(output_mutex);
+				archive.WriteGame(game.GetBoard(), pgn_game.result);
+			}
+			else
+			{
+				// The game is formatted before taking the lock, so the threads only wait for each other to write.
+				pgn_text.str("");
+				WritePgnGame(pgn_text, pgn_game);
+				std::lock_guard<std::mutex> lock(output_mutex);
+				output << pgn_text.str();
+			}
+			int finished = ++finished_games;
+			if (finished % 100 == 0)
+			{
+				double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+				std::lock_guard<std::mutex> lock(output_mutex);
+				cout << finished << " games, " << finished / elapsed << " games/s" << endl;
+			}
+		}
+	};
+	vector<std::thread> workers;
+	for (int i = 0; i < thread_count; i++)
+	{
+		workers.emplace_back(worker);
+	}
+	for (std::thread& thread : workers)
+	{
+		thread.join();
+	}
+	bool written = binary ? archive.Close() : static_cast<bool>(output.flush());
+
+	double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	cout << finished_games << " games in " << elapsed << " s, " << finished_games / (elapsed > 0 ? elapsed : 1e-9) << " games/s\n"
+		<< "White wins " << results[0] << ", black wins " << results[1] << ", draws " << results[2] << endl;
+	return written ? 0 : 1;
+}
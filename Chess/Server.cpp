@@ -0,0 +1,214 @@
+#include "GameServer.h"
+
+#ifdef __linux__
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <unordered_map>
+using std::unordered_map;
+
+// A line longer than this is not a command, so the client is dropped rather than buffered without end.
+const size_t kMaxLineLength = 4096;
+const int kMaxEvents = 256;
+
+/**
+ * The buffers of one connected client.
+ */
+struct Connection
+{
+	string input;
+	string output;
+	// Whether the socket is also being watched for room to write.
+	bool waiting_to_write = false;
+};
+
+/**
+ * Writes as much of a client's pending output as the socket takes without blocking. If some is left, the
+ * event loop is asked to say when there is room for more.
+ *
+ * @param epoll: The event loop
+ * @param client: The client's socket
+ * @param connection: The client's buffers
+ * @return: False if the connection has failed, true otherwise.
+ */
+static bool Flush(int epoll, int client, Connection& connection)
+{
+	size_t written = 0;
+	while (written < connection.output.size())
+	{
+		ssize_t count = send(client, connection.output.data() + written, connection.output.size() - written, MSG_NOSIGNAL);
+		if (count < 0)
+		{
+			if (errno == EAGAIN || errno == EWOULDBLOCK)
+			{
+				break;
+			}
+			return false;
+		}
+		written += static_cast<size_t>(count);
+	}
+	connection.output.erase(0, written);
+	bool waiting_to_write = !connection.output.empty();
+	if (waiting_to_write != connection.waiting_to_write)
+	{
+		epoll_event event{};
+		event.events = EPOLLIN | (waiting_to_write ? static_cast<uint32_t>(EPOLLOUT) : 0u);
+		event.data.fd = client;
+		epoll_ctl(epoll, EPOLL_CTL_MOD, client, &event);
+		connection.waiting_to_write = waiting_to_write;
+	}
+	return true;
+}
+
+/**
+ * Hosts many games in one process for clients on a local socket. One thread serves every client with an
+ * epoll event loop, so an idle game costs only its session and an idle client only its buffers.
+ * See GameServer.h for the protocol.
+ *
+ * Usage:
+ *   server [socket path]
+ *
+ * @return: 0 when stopped cleanly, 1 if the socket could not be set up.
+ */
+int main(int argc, char* argv[])
+{
+	string path = argc >= 2 ? argv[1] : "/tmp/chess.sock";
+	int listener = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0);
+	sockaddr_un address{};
+	address.sun_family = AF_UNIX;
+	if (listener < 0 || path.size() >= sizeof(address.sun_path))
+	{
+		cout << "Could not create a socket at " << path << endl;
+		return 1;
+	}
+	std::strcpy(address.sun_path, path.c_str());
+	unlink(path.c_str());
+	if (bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(listener, SOMAXCONN) != 0)
+	{
+		cout << "Could not listen on " << path << ": " << std::strerror(errno) << endl;
+		return 1;
+	}
+
+	int epoll = epoll_create1(0);
+	epoll_event listen_event{};
+	listen_event.events = EPOLLIN;
+	listen_event.data.fd = listener;
+	epoll_ctl(epoll, EPOLL_CTL_ADD, listener, &listen_event);
+
+	unordered_map<int, Connection> connections;
+	vector<int> pending_output;
+	GameServer server([&](int client, const string& message)
+	{
+		auto found = connections.find(client);
+		if (found != connections.end())
+		{
+			if (found->second.output.empty())
+			{
+				pending_output.push_back(client);
+			}
+			found->second.output += message;
+		}
+	});
+	cout << "Listening on " << path << endl;
+
+	array<epoll_event, kMaxEvents> events;
+	while (true)
+	{
+		int count = epoll_wait(epoll, events.data(), kMaxEvents, -1);
+		if (count < 0 && errno != EINTR)
+		{
+			break;
+		}
+		for (int i = 0; i < count; i++)
+		{
+			int client = events[i].data.fd;
+			if (client == listener)
+			{
+				int accepted;
+				while ((accepted = accept4(listener, nullptr, nullptr, SOCK_NONBLOCK)) >= 0)
+				{
+					epoll_event event{};
+					event.events = EPOLLIN;
+					event.data.fd = accepted;
+					epoll_ctl(epoll, EPOLL_CTL_ADD, accepted, &event);
+					connections[accepted] = Connection();
+				}
+				continue;
+			}
+
+			auto found = connections.find(client);
+			if (found == connections.end())
+			{
+				continue;
+			}
+			Connection& connection = found->second;
+			bool open = (events[i].events & (EPOLLERR | EPOLLHUP)) == 0 || (events[i].events & EPOLLIN);
+			if (events[i].events & EPOLLIN)
+			{
+				char buffer[4096];
+				ssize_t received;
+				while ((received = recv(client, buffer, sizeof(buffer), 0)) > 0)
+				{
+					connection.input.append(buffer, static_cast<size_t>(received));
+				}
+				open = received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+				// Answer every complete line. A partial line waits for the rest to arrive.
+				size_t line_start = 0;
+				size_t line_end;
+				while ((line_end = connection.input.find('\n', line_start)) != string::npos)
+				{
+					size_t length = line_end - line_start;
+					if (length > 0 && connection.input[line_end - 1] == '\r')
+					{
+						length--;
+					}
+					server.HandleLine(client, connection.input.substr(line_start, length));
+					line_start = line_end + 1;
+				}
+				connection.input.erase(0, line_start);
+				open = open && connection.input.size() <= kMaxLineLength;
+			}
+			if ((events[i].events & EPOLLOUT) && !Flush(epoll, client, connection))
+			{
+				open = false;
+			}
+			if (!open)
+			{
+				// A client that sent its commands and then hung up still gets its replies, as far as the socket takes them.
+				Flush(epoll, client, connection);
+				server.RemoveClient(client);
+				epoll_ctl(epoll, EPOLL_CTL_DEL, client, nullptr);
+				close(client);
+				connections.erase(client);
+			}
+		}
+
+		// Replies and updates from this round of events go out together, one write per client.
+		for (int client : pending_output)
+		{
+			auto found = connections.find(client);
+			if (found != connections.end() && !Flush(epoll, client, found->second))
+			{
+				server.RemoveClient(client);
+				epoll_ctl(epoll, EPOLL_CTL_DEL, client, nullptr);
+				close(client);
+				connections.erase(found);
+			}
+		}
+		pending_output.clear();
+	}
+	close(epoll);
+	close(listener);
+	return 0;
+}
+#else
+int main()
+{
+	cout << "The game server needs epoll and is only available on Linux." << endl;
+	return 1;
+}
+#endif
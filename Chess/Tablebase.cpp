@@ -0,0 +1,718 @@
+#include "Tablebase.h"
+#include "MoveGen.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+// The pieces in the order they are written in a table's name, strongest first.
+static const char kPieceLetters[] = "KQRBNP";
+static const Piece kLetterPieces[] = { Piece::King, Piece::Queen, Piece::Rook, Piece::Bishop, Piece::Knight, Piece::Pawn };
+
+/**
+ * The ways of turning and mirroring the board, and the placements of the two kings each table is built for.
+ */
+struct TablebaseSymmetry
+{
+	// The square each square moves to under each of the eight ways of turning the board. Bit 0 of the way
+	// mirrors the files, bit 1 mirrors the ranks and bit 2 swaps files with ranks.
+	array<array<uint8_t, 64>, 8> transformed{};
+	// The way that moves a pawnless position with the kings on these squares into the a1-d1-d4 triangle.
+	array<array<uint8_t, 64>, 64> king_transform{};
+	// The number of each placement of the kings inside the triangle, or -1 if it is not used.
+	array<array<int16_t, 64>, 64> king_pair_index{};
+	// The white and black king squares of each king placement number.
+	array<array<uint8_t, 2>, kPawnlessKingPlacements> king_pairs{};
+};
+
+/**
+ * @param square: The square, using the board's numbering
+ * @param way: Which of the eight ways to turn the board
+ * @return: The square it moves to.
+ */
+static constexpr int TransformSquare(int square, int way)
+{
+	int file = square % 8;
+	int rank = 7 - square / 8;
+	if (way & 1)
+	{
+		file = 7 - file;
+	}
+	if (way & 2)
+	{
+		rank = 7 - rank;
+	}
+	if (way & 4)
+	{
+		int swap = file;
+		file = rank;
+		rank = swap;
+	}
+	return (7 - rank) * 8 + file;
+}
+
+/**
+ * @return: True if the white king is in the a1-d1-d4 triangle and, when it stands on the long diagonal,
+ * the black king is on or below that diagonal.
+ */
+static constexpr bool IsCanonicalKingPair(int white_king, int black_king)
+{
+	int white_file = white_king % 8;
+	int white_rank = 7 - white_king / 8;
+	if (white_file > 3 || white_rank > white_file)
+	{
+		return false;
+	}
+	return white_rank < white_file || 7 - black_king / 8 <= black_king % 8;
+}
+
+/**
+ * @return: Every way of turning the board, and the number of each placement of the kings.
+ */
+static constexpr TablebaseSymmetry MakeTablebaseSymmetry()
+{
+	TablebaseSymmetry symmetry;
+	for (int way = 0; way < 8; way++)
+	{
+		for (int square = 0; square < 64; square++)
+		{
+			symmetry.transformed[way][square] = static_cast<uint8_t>(TransformSquare(square, way));
+		}
+	}
+	for (int white_king = 0; white_king < 64; white_king++)
+	{
+		for (int black_king = 0; black_king < 64; black_king++)
+		{
+			symmetry.king_pair_index[white_king][black_king] = -1;
+			for (int way = 0; way < 8; way++)
+			{
+				if (IsCanonicalKingPair(TransformSquare(white_king, way), TransformSquare(black_king, way)))
+				{
+					symmetry.king_transform[white_king][black_king] = static_cast<uint8_t>(way);
+					break;
+				}
+			}
+		}
+	}
+	int count = 0;
+	for (int white_king = 0; white_king < 64; white_king++)
+	{
+		for (int black_king = 0; black_king < 64; black_king++)
+		{
+			int rows = white_king / 8 - black_king / 8;
+			int columns = white_king % 8 - black_king % 8;
+			bool touching = rows >= -1 && rows <= 1 && columns >= -1 && columns <= 1;
+			if (!touching && IsCanonicalKingPair(white_king, black_king))
+			{
+				symmetry.king_pair_index[white_king][black_king] = static_cast<int16_t>(count);
+				symmetry.king_pairs[count] = { static_cast<uint8_t>(white_king), static_cast<uint8_t>(black_king) };
+				count++;
+			}
+		}
+	}
+	return symmetry;
+}
+
+static constexpr TablebaseSymmetry kSymmetry = MakeTablebaseSymmetry();
+
+/**
+ * Reads a table name such as "KQKR".
+ *
+ * @param name: The name: a king, white's other pieces, a king and black's other pieces
+ * @return: True if the name was read, false if it is not a table of at most five pieces.
+ */
+bool TablebasePieces::FromName(const string& name)
+{
+	count = 0;
+	has_pawns = false;
+	size_t black_king = name.find('K', 1);
+	if (name.empty() || name[0] != 'K' || black_king == string::npos || name.size() > kMaxTablebasePieces)
+	{
+		return false;
+	}
+	pieces[count++] = ChessPiece(Color::White, Piece::King);
+	pieces[count++] = ChessPiece(Color::Black, Piece::King);
+	for (size_t i = 1; i < name.size(); i++)
+	{
+		if (i == black_king)
+		{
+			continue;
+		}
+		const char* letter = std::strchr(kPieceLetters + 1, name[i]);
+		if (letter == nullptr || name[i] == '\0')
+		{
+			return false;
+		}
+		Piece piece = kLetterPieces[letter - kPieceLetters];
+		pieces[count++] = ChessPiece(i < black_king ? Color::White : Color::Black, piece);
+		has_pawns = has_pawns || piece == Piece::Pawn;
+	}
+	return true;
+}
+
+/**
+ * @return: The table name for the pieces, such as "KQKR".
+ */
+string TablebasePieces::GetName() const
+{
+	string name;
+	for (Color color : { Color::White, Color::Black })
+	{
+		for (int i = 0; i < count; i++)
+		{
+			if (pieces[i].GetColor() == color)
+			{
+				name.push_back("-PNBRQK"[static_cast<int>(pieces[i].GetPiece())]);
+			}
+		}
+	}
+	return name;
+}
+
+/**
+ * @param first: One side's pieces after the king, strongest first
+ * @param second: The other side's pieces after the king, strongest first
+ * @return: True if the first side has more pieces, or as many and the first difference is a stronger piece.
+ */
+static bool IsStronger(const string& first, const string& second)
+{
+	if (first.size() != second.size())
+	{
+		return first.size() > second.size();
+	}
+	for (size_t i = 0; i < first.size(); i++)
+	{
+		if (first[i] != second[i])
+		{
+			return std::strchr(kPieceLetters, first[i]) < std::strchr(kPieceLetters, second[i]);
+		}
+	}
+	return false;
+}
+
+/**
+ * Puts a table name into the form tables are built under: each side's pieces strongest first, and the
+ * stronger side as white. "KKRQ" becomes "KQRK", for example.
+ *
+ * @param name: A table name
+ * @return: The name tables with these pieces are built under, or an empty string if the name cannot be read.
+ */
+string CanonicalTablebaseName(const string& name)
+{
+	size_t black_king = name.find('K', 1);
+	if (name.empty() || name[0] != 'K' || black_king == string::npos)
+	{
+		return "";
+	}
+	string white = name.substr(1, black_king - 1);
+	string black = name.substr(black_king + 1);
+	auto by_strength = [](char first, char second) { return std::strchr(kPieceLetters, first) < std::strchr(kPieceLetters, second); };
+	std::sort(white.begin(), white.end(), by_strength);
+	std::sort(black.begin(), black.end(), by_strength);
+	if (IsStronger(black, white))
+	{
+		std::swap(white, black);
+	}
+	return "K" + white + "K" + black;
+}
+
+/**
+ * @param chess_piece: One of a table's pieces other than the kings
+ * @return: The number of squares the piece is numbered over. Pawns never stand on the first or last rank.
+ */
+static uint64_t PlacementCount(const ChessPiece& chess_piece)
+{
+	return chess_piece.GetPiece() == Piece::Pawn ? kPawnPlacements : kPiecePlacements;
+}
+
+/**
+ * @return: The number of positions of a table for each side to move.
+ */
+uint64_t TablebasePositionCount(const TablebasePieces& pieces)
+{
+	uint64_t count = pieces.has_pawns ? kPawnKingPlacements : kPawnlessKingPlacements;
+	for (int i = 2; i < pieces.count; i++)
+	{
+		count *= PlacementCount(pieces.pieces[i]);
+	}
+	return count;
+}
+
+/**
+ * Works out the number of a position in a table, turning the board first so that the white king is where
+ * the table expects it. Positions with white to move come first, then those with black to move.
+ * Some numbers are never given out, such as those of positions that are the mirror image of another.
+ *
+ * @param pieces: The table's pieces
+ * @param position: The square of each piece and the side to move
+ * @param index: Set to the number of the position
+ * @return: True if the position has a number, false if the kings stand on the same or neighbouring squares
+ * or a pawn stands on the first or last rank.
+ */
+bool TablebaseIndex(const TablebasePieces& pieces, const TablebasePosition& position, uint64_t& index)
+{
+	int white_king = position.squares[0];
+	int black_king = position.squares[1];
+	int way;
+	if (pieces.has_pawns)
+	{
+		way = white_king % 8 > 3 ? 1 : 0;
+		int transformed_king = kSymmetry.transformed[way][white_king];
+		index = ((transformed_king / 8) * 4 + transformed_king % 8) * 64 + kSymmetry.transformed[way][black_king];
+	}
+	else
+	{
+		way = kSymmetry.king_transform[white_king][black_king];
+		int king_pair = kSymmetry.king_pair_index[kSymmetry.transformed[way][white_king]][kSymmetry.transformed[way][black_king]];
+		if (king_pair < 0)
+		{
+			return false;
+		}
+		index = static_cast<uint64_t>(king_pair);
+		// With both kings on the long diagonal, mirroring across it leaves the kings in place, so the first other
+		// piece off the diagonal decides which way round the position is numbered.
+		int white_king_square = kSymmetry.transformed[way][white_king];
+		int black_king_square = kSymmetry.transformed[way][black_king];
+		if (white_king_square % 8 == 7 - white_king_square / 8 && black_king_square % 8 == 7 - black_king_square / 8)
+		{
+			for (int i = 2; i < pieces.count; i++)
+			{
+				int square = kSymmetry.transformed[way][position.squares[i]];
+				if (7 - square / 8 != square % 8)
+				{
+					way = 7 - square / 8 > square % 8 ? way ^ 4 : way;
+					break;
+				}
+			}
+		}
+	}
+	for (int i = 2; i < pieces.count; i++)
+	{
+		int square = kSymmetry.transformed[way][position.squares[i]];
+		if (pieces.pieces[i].GetPiece() == Piece::Pawn)
+		{
+			if (square < 8 || square >= 56)
+			{
+				return false;
+			}
+			// Pawns are numbered from the first square of the second row.
+			square -= 8;
+		}
+		index = index * PlacementCount(pieces.pieces[i]) + square;
+	}
+	if (position.side_to_move == Color::Black)
+	{
+		index += TablebasePositionCount(pieces);
+	}
+	return true;
+}
+
+/**
+ * Turns a position number back into the squares of the pieces. This is the reverse of TablebaseIndex
+ * for positions already turned the way the table expects.
+ *
+ * @param pieces: The table's pieces
+ * @param index: The number of the position
+ * @param position: Set to the square of each piece and the side to move
+ * @return: None
+ */
+void TablebaseSquares(const TablebasePieces& pieces, uint64_t index, TablebasePosition& position)
+{
+	uint64_t position_count = TablebasePositionCount(pieces);
+	position.side_to_move = index >= position_count ? Color::Black : Color::White;
+	index %= position_count;
+	for (int i = pieces.count - 1; i >= 2; i--)
+	{
+		uint64_t placements = PlacementCount(pieces.pieces[i]);
+		position.squares[i] = static_cast<int>(index % placements) + (pieces.pieces[i].GetPiece() == Piece::Pawn ? 8 : 0);
+		index /= placements;
+	}
+	if (pieces.has_pawns)
+	{
+		int white_king = static_cast<int>(index / 64);
+		position.squares[0] = (white_king / 4) * 8 + white_king % 4;
+		position.squares[1] = static_cast<int>(index % 64);
+	}
+	else
+	{
+		position.squares[0] = kSymmetry.king_pairs[index][0];
+		position.squares[1] = kSymmetry.king_pairs[index][1];
+	}
+}
+
+/**
+ * @param value: A value as stored in a table
+ * @return: What the value means for the side to move.
+ */
+TablebaseProbe TablebaseProbeFromValue(int value)
+{
+	TablebaseProbe probe;
+	if (value == 0)
+	{
+		probe.result = TablebaseResult::Draw;
+		return probe;
+	}
+	probe.distance = value - 1;
+	probe.result = probe.distance % 2 == 1 ? TablebaseResult::Win : TablebaseResult::Loss;
+	return probe;
+}
+
+/**
+ * Maps a table file into memory, after checking that its size matches its header.
+ *
+ * @param path: The table file
+ * @return: True if the table was opened, false otherwise.
+ */
+bool Tablebase::Open(const string& path)
+{
+	if (!file_.Open(path) || file_.GetSize() < kTablebaseHeaderSize
+		|| std::memcmp(file_.GetData(), kTablebaseMagic, sizeof(kTablebaseMagic)) != 0)
+	{
+		file_.Close();
+		return false;
+	}
+	const unsigned char* header = reinterpret_cast<const unsigned char*>(file_.GetData());
+	string name(reinterpret_cast<const char*>(header) + 8, strnlen(reinterpret_cast<const char*>(header) + 8, 8));
+	uint32_t value_bits = 0;
+	uint32_t max_distance = 0;
+	uint64_t position_count = 0;
+	for (int i = 3; i >= 0; i--)
+	{
+		value_bits = (value_bits << 8) | header[16 + i];
+		max_distance = (max_distance << 8) | header[20 + i];
+	}
+	for (int i = 7; i >= 0; i--)
+	{
+		position_count = (position_count << 8) | header[24 + i];
+	}
+	if (!pieces_.FromName(name) || position_count != TablebasePositionCount(pieces_) || value_bits > 8
+		|| file_.GetSize() < kTablebaseHeaderSize + (2 * position_count * value_bits + 7) / 8 + 1)
+	{
+		file_.Close();
+		return false;
+	}
+	position_count_ = position_count;
+	value_bits_ = static_cast<int>(value_bits);
+	max_distance_ = static_cast<int>(max_distance);
+	values_ = header + kTablebaseHeaderSize;
+	return true;
+}
+
+/**
+ * Packs the values worked out by the generator into as few bits as the longest mate needs.
+ *
+ * @param pieces: The table's pieces
+ * @param values: One value for every position, as stored in a table. A value of 255 marks a position
+ * that cannot occur and is stored as 0.
+ * @return: None
+ */
+void Tablebase::SetValues(const TablebasePieces& pieces, const std::atomic<uint8_t>* values)
+{
+	pieces_ = pieces;
+	position_count_ = TablebasePositionCount(pieces);
+	uint64_t value_count = 2 * position_count_;
+	int max_value = 0;
+	for (uint64_t index = 0; index < value_count; index++)
+	{
+		int value = values[index].load(std::memory_order_relaxed);
+		if (value != 255 && value > max_value)
+		{
+			max_value = value;
+		}
+	}
+	max_distance_ = max_value > 0 ? max_value - 1 : 0;
+	value_bits_ = 0;
+	while ((1 << value_bits_) <= max_value)
+	{
+		value_bits_++;
+	}
+	// One spare byte lets GetValue always read two bytes.
+	packed_.assign((value_count * value_bits_ + 7) / 8 + 1, 0);
+	for (uint64_t index = 0; index < value_count; index++)
+	{
+		unsigned value = values[index].load(std::memory_order_relaxed);
+		if (value == 255 || value == 0)
+		{
+			continue;
+		}
+		uint64_t bit = index * value_bits_;
+		packed_[bit / 8] |= static_cast<unsigned char>(value << (bit % 8));
+		packed_[bit / 8 + 1] |= static_cast<unsigned char>(value >> (8 - bit % 8));
+	}
+	values_ = packed_.data();
+}
+
+/**
+ * Writes a table built in memory to a file.
+ *
+ * @param path: The file to write
+ * @return: True if the file was written, false otherwise.
+ */
+bool Tablebase::Save(const string& path) const
+{
+	std::ofstream file(path, std::ios::binary);
+	if (!file)
+	{
+		return false;
+	}
+	unsigned char header[kTablebaseHeaderSize] = {};
+	std::memcpy(header, kTablebaseMagic, sizeof(kTablebaseMagic));
+	string name = GetName();
+	std::memcpy(header + 8, name.data(), name.size());
+	for (int i = 0; i < 4; i++)
+	{
+		header[16 + i] = static_cast<unsigned char>(value_bits_ >> (8 * i));
+		header[20 + i] = static_cast<unsigned char>(max_distance_ >> (8 * i));
+	}
+	for (int i = 0; i < 8; i++)
+	{
+		header[24 + i] = static_cast<unsigned char>(position_count_ >> (8 * i));
+	}
+	file.write(reinterpret_cast<const char*>(header), kTablebaseHeaderSize);
+	file.write(reinterpret_cast<const char*>(packed_.data()), packed_.size());
+	return static_cast<bool>(file);
+}
+
+/**
+ * @param index: The number of a position, as given by TablebaseIndex
+ * @return: The value stored for the position.
+ */
+int Tablebase::GetValue(uint64_t index) const
+{
+	if (value_bits_ == 0)
+	{
+		return 0;
+	}
+	uint64_t bit = index * value_bits_;
+	unsigned bytes = values_[bit / 8] | values_[bit / 8 + 1] << 8;
+	return static_cast<int>((bytes >> (bit % 8)) & ((1u << value_bits_) - 1));
+}
+
+/**
+ * @param position: The squares of the table's pieces, and the side to move
+ * @return: What the table knows about the position.
+ */
+TablebaseProbe Tablebase::Probe(const TablebasePosition& position) const
+{
+	uint64_t index;
+	if (!TablebaseIndex(pieces_, position, index))
+	{
+		return TablebaseProbe();
+	}
+	return TablebaseProbeFromValue(GetValue(index));
+}
+
+/**
+ * @param counts: The number of each piece of each color, indexed by ColorIndex and then Piece
+ * @return: A key that is the same for every position with those pieces.
+ */
+static uint64_t MaterialKey(const array<array<int, 7>, 2>& counts)
+{
+	uint64_t key = 0;
+	for (int color = 0; color < 2; color++)
+	{
+		for (int piece = static_cast<int>(Piece::Pawn); piece <= static_cast<int>(Piece::King); piece++)
+		{
+			key = (key << 4) | static_cast<uint64_t>(counts[color][piece]);
+		}
+	}
+	return key;
+}
+
+/**
+ * Collects every set of up to a given number of pieces, each written strongest first.
+ *
+ * @param pieces: The pieces so far
+ * @param first_letter: The strongest piece that may still be added, as a position in kPieceLetters
+ * @param max_count: The most pieces in a set
+ * @param sets: Where the sets are collected
+ * @return: None
+ */
+static void CollectPieceSets(const string& pieces, int first_letter, size_t max_count, vector<string>& sets)
+{
+	sets.push_back(pieces);
+	if (pieces.size() == max_count)
+	{
+		return;
+	}
+	for (int letter = first_letter; letter < 6; letter++)
+	{
+		CollectPieceSets(pieces + kPieceLetters[letter], letter, max_count, sets);
+	}
+}
+
+/**
+ * Opens every table file in a directory. Files are named after their table, such as "KQK.tb".
+ *
+ * @param directory: The directory holding the table files
+ * @return: The number of tables opened.
+ */
+int Tablebases::Open(const string& directory)
+{
+	vector<string> sets;
+	CollectPieceSets("", 1, kMaxTablebasePieces - 2, sets);
+	int opened = 0;
+	for (const string& white : sets)
+	{
+		for (const string& black : sets)
+		{
+			string name = "K" + white + "K" + black;
+			if (white.size() + black.size() + 2 > kMaxTablebasePieces || IsStronger(black, white) || Find(name) != nullptr)
+			{
+				continue;
+			}
+			unique_ptr<Tablebase> table(new Tablebase());
+			if (table->Open(directory + "/" + name + ".tb"))
+			{
+				Add(std::move(table));
+				opened++;
+			}
+		}
+	}
+	return opened;
+}
+
+/**
+ * Makes a table available to Probe, for the board as named and with the colors swapped.
+ *
+ * @param table: The table
+ * @return: None
+ */
+void Tablebases::Add(unique_ptr<Tablebase> table)
+{
+	const TablebasePieces& pieces = table->GetPieces();
+	array<array<int, 7>, 2> counts{};
+	for (int i = 0; i < pieces.count; i++)
+	{
+		counts[ColorIndex(pieces.pieces[i].GetColor())][static_cast<int>(pieces.pieces[i].GetPiece())]++;
+	}
+	by_material_.emplace(MaterialKey({ counts[1], counts[0] }), std::make_pair(table.get(), true));
+	// A table with the same pieces on both sides is found the same way either way round.
+	by_material_[MaterialKey(counts)] = std::make_pair(table.get(), false);
+	if (pieces.count > max_pieces_)
+	{
+		max_pieces_ = pieces.count;
+	}
+	tables_.push_back(std::move(table));
+}
+
+/**
+ * @param name: A table name such as "KQK"
+ * @return: The table, or nullptr if it has not been opened or built.
+ */
+const Tablebase* Tablebases::Find(const string& name) const
+{
+	for (const auto& table : tables_)
+	{
+		if (table->GetName() == name)
+		{
+			return table.get();
+		}
+	}
+	return nullptr;
+}
+
+/**
+ * Looks a position up in whichever table has its pieces.
+ *
+ * @param chess_board: The position
+ * @return: What the table knows, or NotFound if there is no table for the pieces, either side may castle
+ * or an en passant capture is possible.
+ */
+TablebaseProbe Tablebases::Probe(const ChessBoard& chess_board) const
+{
+	Bitboard occupied = chess_board.GetOccupied();
+	if (PopCount(occupied) > max_pieces_ || chess_board.GetCastlingRights() != 0)
+	{
+		return TablebaseProbe();
+	}
+	Color side_to_move = chess_board.GetSideToMove();
+	int en_passant_square = chess_board.GetEnPassantSquare();
+	if (en_passant_square != kNoSquare
+		&& (PawnAttacks(GetOppositeColor(side_to_move), en_passant_square) & chess_board.GetPieces(side_to_move, Piece::Pawn)))
+	{
+		return TablebaseProbe();
+	}
+
+	array<array<int, 7>, 2> counts{};
+	for (Color color : { Color::White, Color::Black })
+	{
+		for (int piece = static_cast<int>(Piece::Pawn); piece <= static_cast<int>(Piece::King); piece++)
+		{
+			counts[ColorIndex(color)][piece] = PopCount(chess_board.GetPieces(color, static_cast<Piece>(piece)));
+		}
+	}
+	auto found = by_material_.find(MaterialKey(counts));
+	if (found == by_material_.end())
+	{
+		return TablebaseProbe();
+	}
+	const Tablebase* table = found->second.first;
+	bool swap_colors = found->second.second;
+
+	// With the colors swapped, white's pieces stand in for black's and the board is turned upside down.
+	const TablebasePieces& pieces = table->GetPieces();
+	TablebasePosition position;
+	position.side_to_move = swap_colors ? GetOppositeColor(side_to_move) : side_to_move;
+	// The squares of each kind of piece not yet given to one of the table's pieces.
+	array<array<Bitboard, 7>, 2> remaining{};
+	for (Color color : { Color::White, Color::Black })
+	{
+		for (int piece = static_cast<int>(Piece::Pawn); piece <= static_cast<int>(Piece::King); piece++)
+		{
+			remaining[ColorIndex(color)][piece] = chess_board.GetPieces(color, static_cast<Piece>(piece));
+		}
+	}
+	for (int i = 0; i < pieces.count; i++)
+	{
+		Color color = swap_colors ? GetOppositeColor(pieces.pieces[i].GetColor()) : pieces.pieces[i].GetColor();
+		int square = PopLowestSquare(remaining[ColorIndex(color)][static_cast<int>(pieces.pieces[i].GetPiece())]);
+		position.squares[i] = swap_colors ? square ^ 56 : square;
+	}
+	return table->Probe(position);
+}
+
+/**
+ * Chooses the move that wins fastest, keeps a draw, or holds out longest, by looking up every move's position.
+ *
+ * @param chess_board: The position. It is returned unchanged.
+ * @param probe: Set to what the table knows about the position
+ * @return: The best move, or Move() if the position or one of its moves cannot be looked up.
+ */
+Move Tablebases::FindBestMove(ChessBoard& chess_board, TablebaseProbe& probe) const
+{
+	probe = Probe(chess_board);
+	if (probe.result == TablebaseResult::NotFound)
+	{
+		return Move();
+	}
+	MoveList move_list;
+	GenerateLegalMoves(chess_board, move_list);
+	for (Move move : move_list)
+	{
+		chess_board.MakeMove(move);
+		TablebaseProbe reply = Probe(chess_board);
+		chess_board.UnmakeMove();
+		// A win needs a reply that loses in one ply fewer, a draw a drawn reply, and a loss the longest win for the opponent.
+		bool best = false;
+		switch (probe.result)
+		{
+		case TablebaseResult::Win:
+			best = reply.result == TablebaseResult::Loss && reply.distance == probe.distance - 1;
+			break;
+		case TablebaseResult::Draw:
+			best = reply.result == TablebaseResult::Draw;
+			break;
+		case TablebaseResult::Loss:
+			best = reply.result == TablebaseResult::Win && reply.distance == probe.distance - 1;
+			break;
+		default:
+			break;
+		}
+		if (best)
+		{
+			return move;
+		}
+	}
+	return Move();
+}
@@ -0,0 +1,148 @@
+#pragma once
+#include "ChessBoard.h"
+#include "MappedFile.h"
+
+#include <array>
+using std::array;
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+using std::unique_ptr;
+#include <string>
+using std::string;
+#include <unordered_map>
+#include <vector>
+using std::vector;
+
+/**
+ * An endgame tablebase holds the distance to mate of every position with a given set of pieces, such as
+ * king and queen against king ("KQK"). A table is named by white's pieces and then black's, strongest
+ * first in the order K Q R B N P, and covers the positions where the side with the stronger pieces is white.
+ * The same table answers for the positions with the colors swapped.
+ *
+ * Positions are numbered by where the kings are and then where each other piece is, one of 64 squares for a
+ * piece and one of the 48 squares of ranks 2 to 7 for a pawn. Without pawns the board can be turned and mirrored
+ * eight ways, so the white king is always moved into the a1-d1-d4 triangle, which leaves 462 legal placements of
+ * the two kings. With pawns the board can only be mirrored from side to side, so the white king is moved to files a to d.
+ *
+ * The file is a 32 byte header followed by the value of every position with white to move and then with
+ * black to move, packed into as few bits each as the longest mate in the table needs. All numbers are little-endian.
+ *
+ *   Header: "CHSTB002", the name (8 bytes, padded with zeros), bits per value (4 bytes),
+ *           the longest distance to mate in plies (4 bytes), number of positions for each side to move (8 bytes)
+ *
+ * A value of 0 is a draw (or a position that cannot occur) and any other value is the distance to mate in plies
+ * plus one. An odd distance means the side to move mates, an even distance means the side to move is mated.
+ *
+ * Tables assume that neither side can castle or take en passant, so such positions are never looked up.
+ */
+const int kMaxTablebasePieces = 5;
+const char kTablebaseMagic[8] = { 'C', 'H', 'S', 'T', 'B', '0', '0', '2' };
+const size_t kTablebaseHeaderSize = 32;
+// The number of placements of the two kings, and what each other piece multiplies the count by.
+const uint64_t kPawnlessKingPlacements = 462;
+const uint64_t kPawnKingPlacements = 32 * 64;
+const uint64_t kPiecePlacements = 64;
+const uint64_t kPawnPlacements = 48;
+
+enum class TablebaseResult { NotFound, Draw, Win, Loss };
+
+/**
+ * What a tablebase knows about a position, from the side to move's point of view.
+ */
+struct TablebaseProbe
+{
+	TablebaseResult result = TablebaseResult::NotFound;
+	// The number of plies to mate with best play, for a win or a loss.
+	int distance = 0;
+};
+
+/**
+ * The pieces of one table, in the order their squares make up a position's number: the white king,
+ * the black king, then white's other pieces and black's other pieces.
+ */
+struct TablebasePieces
+{
+	int count = 0;
+	array<ChessPiece, kMaxTablebasePieces> pieces;
+	bool has_pawns = false;
+
+	bool FromName(const string& name);
+	string GetName() const;
+};
+
+/**
+ * The squares of a table's pieces, in the table's order, and the side to move.
+ */
+struct TablebasePosition
+{
+	array<int, kMaxTablebasePieces> squares{};
+	Color side_to_move = Color::White;
+};
+
+/**
+ * One table, either mapped from its file or built in memory by the generator.
+ */
+class Tablebase
+{
+private:
+	TablebasePieces pieces_;
+	uint64_t position_count_ = 0;
+	int value_bits_ = 0;
+	int max_distance_ = 0;
+	MappedFile file_;
+	// The packed values, when the table was built in memory rather than mapped.
+	vector<unsigned char> packed_;
+	const unsigned char* values_ = nullptr;
+
+public:
+	Tablebase() = default;
+	Tablebase(const Tablebase&) = delete;
+	Tablebase& operator=(const Tablebase&) = delete;
+
+	bool Open(const string& path);
+	void SetValues(const TablebasePieces& pieces, const std::atomic<uint8_t>* values);
+	bool Save(const string& path) const;
+
+	const TablebasePieces& GetPieces() const { return pieces_; }
+	string GetName() const { return pieces_.GetName(); }
+	uint64_t GetPositionCount() const { return position_count_; }
+	int GetMaxDistance() const { return max_distance_; }
+
+	int GetValue(uint64_t index) const;
+	TablebaseProbe Probe(const TablebasePosition& position) const;
+};
+
+string CanonicalTablebaseName(const string& name);
+
+uint64_t TablebasePositionCount(const TablebasePieces& pieces);
+
+bool TablebaseIndex(const TablebasePieces& pieces, const TablebasePosition& position, uint64_t& index);
+
+void TablebaseSquares(const TablebasePieces& pieces, uint64_t index, TablebasePosition& position);
+
+TablebaseProbe TablebaseProbeFromValue(int value);
+
+/**
+ * Every table that has been opened or built, found by the pieces on the board.
+ */
+class Tablebases
+{
+private:
+	vector<unique_ptr<Tablebase>> tables_;
+	// A key made from the number of each piece of each color, for the board as it is and with colors swapped.
+	// The flag is set when the colors must be swapped to look the position up.
+	std::unordered_map<uint64_t, std::pair<const Tablebase*, bool>> by_material_;
+	int max_pieces_ = 0;
+
+public:
+	int Open(const string& directory);
+	void Add(unique_ptr<Tablebase> table);
+	const Tablebase* Find(const string& name) const;
+	int GetMaxPieces() const { return max_pieces_; }
+	size_t GetTableCount() const { return tables_.size(); }
+
+	TablebaseProbe Probe(const ChessBoard& chess_board) const;
+	Move FindBestMove(ChessBoard& chess_board, TablebaseProbe& probe) const;
+};
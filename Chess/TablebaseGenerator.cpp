@@ -0,0 +1,468 @@
+#include "TablebaseGenerator.h"
+#include "MoveGen.h"
+
+#include <chrono>
+#include <thread>
+
+// How many positions a thread takes at a time.
+const uint64_t kPositionsPerBlock = 4096;
+// The longest distance to mate that fits in a byte alongside the marker for positions that cannot occur.
+const int kMaxTablebaseDistance = 253;
+const uint8_t kImpossiblePosition = 255;
+
+/**
+ * What one thread works with: its own board, and what it found out about the last position it evaluated.
+ */
+struct TablebaseScratch
+{
+	ChessBoard board;
+	// The squares that hold pieces on the board, so that setting up the next position only clears those.
+	array<int, kMaxTablebasePieces> occupied_squares{};
+	int occupied_count = 0;
+
+	// The outcome of the last evaluated position, from the side to move's point of view.
+	int move_count = 0;
+	// Moves that keep every piece on the board, and so lead to another position of the same table.
+	int table_move_count = 0;
+	// The shortest known win in plies, or -1.
+	int fastest_win = -1;
+	// Set while every move is known to lose, and the longest of those losses in plies.
+	bool all_moves_lose = true;
+	int slowest_loss = 0;
+	bool can_draw = false;
+};
+
+/**
+ * Puts a position on a thread's board. Every piece is marked as having moved, so there are no castling rights.
+ *
+ * @param pieces: The table's pieces
+ * @param position: The squares of the pieces and the side to move
+ * @param scratch: The thread's board
+ * @return: None
+ */
+static void SetUpBoard(const TablebasePieces& pieces, const TablebasePosition& position, TablebaseScratch& scratch)
+{
+	for (int i = 0; i < scratch.occupied_count; i++)
+	{
+		scratch.board.ClearSquare(scratch.occupied_squares[i]);
+	}
+	for (int i = 0; i < pieces.count; i++)
+	{
+		ChessPiece chess_piece = pieces.pieces[i];
+		chess_piece.SetHasMoved(true);
+		scratch.board.PlacePiece(position.squares[i], chess_piece);
+		scratch.occupied_squares[i] = position.squares[i];
+	}
+	scratch.occupied_count = pieces.count;
+	scratch.board.SetSideToMove(position.side_to_move);
+}
+
+/**
+ * @param tablebases: Where the smaller tables are found, and where each new table is added
+ * @param directory: Where table files are read from and written to, or empty to keep tables in memory only
+ * @param thread_count: The number of threads to build each table with
+ */
+TablebaseGenerator::TablebaseGenerator(Tablebases& tablebases, const string& directory, int thread_count)
+	: tablebases_(tablebases), directory_(directory), thread_count_(thread_count > 0 ? thread_count : 1)
+{
+}
+
+/**
+ * Runs a function for every position of the table being built, shared out between the threads in blocks.
+ *
+ * @param visit: Called with the number of each position and the calling thread's scratch space
+ * @return: None
+ */
+void TablebaseGenerator::ForEachPosition(const std::function<void(uint64_t, TablebaseScratch&)>& visit)
+{
+	std::atomic<uint64_t> next_block{ 0 };
+	auto work = [this, &visit, &next_block]()
+	{
+		TablebaseScratch scratch;
+		uint64_t begin;
+		while ((begin = next_block.fetch_add(kPositionsPerBlock, std::memory_order_relaxed)) < value_count_)
+		{
+			uint64_t end = begin + kPositionsPerBlock < value_count_ ? begin + kPositionsPerBlock : value_count_;
+			for (uint64_t index = begin; index < end; index++)
+			{
+				visit(index, scratch);
+			}
+		}
+	};
+	vector<std::thread> workers;
+	for (int i = 1; i < thread_count_; i++)
+	{
+		workers.emplace_back(work);
+	}
+	work();
+	for (std::thread& worker : workers)
+	{
+		worker.join();
+	}
+}
+
+/**
+ * Stores a position's distance to mate and keeps track of the longest one.
+ *
+ * @param index: The number of the position
+ * @param distance: The distance to mate in plies
+ * @return: None
+ */
+void TablebaseGenerator::SetValue(uint64_t index, int distance)
+{
+	if (distance > kMaxTablebaseDistance)
+	{
+		too_long_.store(true, std::memory_order_relaxed);
+		return;
+	}
+	values_[index].store(static_cast<uint8_t>(distance + 1), std::memory_order_relaxed);
+	int longest = max_distance_.load(std::memory_order_relaxed);
+	while (distance > longest && !max_distance_.compare_exchange_weak(longest, distance, std::memory_order_relaxed))
+	{
+	}
+}
+
+/**
+ * Works out what is known about every move of a position, leaving the result in the scratch space.
+ * Captures and promotions are looked up in the smaller tables. Other moves are looked up in the table being
+ * built, where a loss is always final but a win only counts once it is no longer than the last finished pass,
+ * since a win found through a capture may still be beaten by a faster one.
+ *
+ * @param position: The position
+ * @param pass: The current pass
+ * @param use_table: Whether to look at moves within the table being built
+ * @param scratch: The thread's board, and where the outcome is stored
+ * @return: None
+ */
+void TablebaseGenerator::Evaluate(const TablebasePosition& position, int pass, bool use_table, TablebaseScratch& scratch)
+{
+	scratch.table_move_count = 0;
+	scratch.fastest_win = -1;
+	scratch.all_moves_lose = true;
+	scratch.slowest_loss = 0;
+	scratch.can_draw = false;
+
+	SetUpBoard(pieces_, position, scratch);
+	ChessBoard& chess_board = scratch.board;
+	MoveList move_list;
+	GenerateLegalMoves(chess_board, move_list);
+	scratch.move_count = move_list.Size();
+	for (Move move : move_list)
+	{
+		TablebaseProbe reply;
+		bool known = true;
+		if (move.GetType() == MoveType::Promotion || chess_board.GetPieceAt(move.GetEnd()).GetColor() != Color::Empty)
+		{
+			chess_board.MakeMove(move);
+			reply = tablebases_.Probe(chess_board);
+			chess_board.UnmakeMove();
+		}
+		else
+		{
+			scratch.table_move_count++;
+			TablebasePosition next = position;
+			for (int i = 0; i < pieces_.count; i++)
+			{
+				if (next.squares[i] == move.GetStart())
+				{
+					next.squares[i] = move.GetEnd();
+				}
+			}
+			next.side_to_move = GetOppositeColor(position.side_to_move);
+			uint64_t next_index;
+			int value = 0;
+			if (use_table && TablebaseIndex(pieces_, next, next_index))
+			{
+				value = values_[next_index].load(std::memory_order_relaxed);
+			}
+			reply = TablebaseProbeFromValue(value == kImpossiblePosition ? 0 : value);
+			known = value != 0 && value != kImpossiblePosition
+				&& (reply.result == TablebaseResult::Loss || reply.distance <= pass - 1);
+		}
+
+		if (!known)
+		{
+			scratch.all_moves_lose = false;
+		}
+		else if (reply.result == TablebaseResult::Loss)
+		{
+			scratch.all_moves_lose = false;
+			if (scratch.fastest_win < 0 || reply.distance + 1 < scratch.fastest_win)
+			{
+				scratch.fastest_win = reply.distance + 1;
+			}
+		}
+		else if (reply.result == TablebaseResult::Win)
+		{
+			if (reply.distance + 1 > scratch.slowest_loss)
+			{
+				scratch.slowest_loss = reply.distance + 1;
+			}
+		}
+		else
+		{
+			// A draw, or a smaller table that is missing, which is treated as a draw.
+			scratch.all_moves_lose = false;
+			scratch.can_draw = true;
+		}
+	}
+}
+
+/**
+ * The first pass over a position: marks it if it cannot occur or is never looked up, and settles it if it is
+ * checkmate or every move is a capture or promotion. Otherwise a win through a capture or promotion is stored,
+ * and later passes may replace it with a faster win.
+ *
+ * @param index: The number of the position
+ * @param scratch: The thread's scratch space
+ * @return: None
+ */
+void TablebaseGenerator::InitializePosition(uint64_t index, TablebaseScratch& scratch)
+{
+	TablebasePosition position;
+	TablebaseSquares(pieces_, index, position);
+	// Numbers that are the mirror image of another position are never looked up.
+	uint64_t own_index;
+	if (!TablebaseIndex(pieces_, position, own_index) || own_index != index)
+	{
+		values_[index].store(kImpossiblePosition, std::memory_order_relaxed);
+		return;
+	}
+	// Pawns are never numbered on the first or last rank, but pieces may share a square.
+	Bitboard occupied = kEmptyBitboard;
+	for (int i = 0; i < pieces_.count; i++)
+	{
+		int square = position.squares[i];
+		if (occupied & SquareBit(square))
+		{
+			values_[index].store(kImpossiblePosition, std::memory_order_relaxed);
+			return;
+		}
+		occupied |= SquareBit(square);
+	}
+	// The side that has just moved may not be left in check.
+	SetUpBoard(pieces_, position, scratch);
+	Color side_to_move = position.side_to_move;
+	int enemy_king = position.squares[side_to_move == Color::White ? 1 : 0];
+	int king = position.squares[side_to_move == Color::White ? 0 : 1];
+	if (IsSquareAttacked(scratch.board, enemy_king, side_to_move))
+	{
+		values_[index].store(kImpossiblePosition, std::memory_order_relaxed);
+		return;
+	}
+
+	Evaluate(position, 0, false, scratch);
+	if (scratch.move_count == 0)
+	{
+		// Checkmate is a loss in 0 plies. Stalemate stays a draw.
+		if (IsSquareAttacked(scratch.board, king, GetOppositeColor(side_to_move)))
+		{
+			SetValue(index, 0);
+		}
+	}
+	else if (scratch.fastest_win >= 0)
+	{
+		SetValue(index, scratch.fastest_win);
+	}
+	else if (scratch.table_move_count == 0 && scratch.all_moves_lose)
+	{
+		SetValue(index, scratch.slowest_loss);
+	}
+}
+
+/**
+ * Takes a position settled in the last pass and checks every position that could have come before it.
+ * In an odd pass the position is a loss and its predecessors may win; in an even pass it is a win and its
+ * predecessors may lose.
+ *
+ * @param index: The number of a position
+ * @param pass: The current pass. Only positions settled at a distance of pass - 1 are looked at.
+ * @param scratch: The thread's scratch space
+ * @return: None
+ */
+void TablebaseGenerator::ResolvePredecessors(uint64_t index, int pass, TablebaseScratch& scratch)
+{
+	if (values_[index].load(std::memory_order_relaxed) != pass)
+	{
+		return;
+	}
+	TablebasePosition position;
+	TablebaseSquares(pieces_, index, position);
+	Color mover = GetOppositeColor(position.side_to_move);
+	Bitboard occupied = kEmptyBitboard;
+	for (int i = 0; i < pieces_.count; i++)
+	{
+		occupied |= SquareBit(position.squares[i]);
+	}
+
+	for (int i = 0; i < pieces_.count; i++)
+	{
+		if (pieces_.pieces[i].GetColor() != mover)
+		{
+			continue;
+		}
+		// The squares the piece could have come from without taking anything.
+		int square = position.squares[i];
+		Bitboard starts = kEmptyBitboard;
+		switch (pieces_.pieces[i].GetPiece())
+		{
+		case Piece::King:
+			starts = KingAttacks(square);
+			break;
+		case Piece::Knight:
+			starts = KnightAttacks(square);
+			break;
+		case Piece::Bishop:
+			starts = BishopAttacks(square, occupied);
+			break;
+		case Piece::Rook:
+			starts = RookAttacks(square, occupied);
+			break;
+		case Piece::Queen:
+			starts = QueenAttacks(square, occupied);
+			break;
+		case Piece::Pawn:
+		{
+			// White pawns move towards row 0, so they came from a higher row.
+			int step = mover == Color::White ? 8 : -8;
+			int back = square + step;
+			int double_row = mover == Color::White ? 4 : 3;
+			if (back >= 8 && back < 56 && !(occupied & SquareBit(back)))
+			{
+				starts |= SquareBit(back);
+				if (square / 8 == double_row && !(occupied & SquareBit(back + step)))
+				{
+					starts |= SquareBit(back + step);
+				}
+			}
+			break;
+		}
+		default:
+			break;
+		}
+		starts &= ~occupied;
+
+		while (starts)
+		{
+			TablebasePosition previous = position;
+			previous.squares[i] = PopLowestSquare(starts);
+			previous.side_to_move = mover;
+			uint64_t previous_index;
+			if (!TablebaseIndex(pieces_, previous, previous_index))
+			{
+				continue;
+			}
+			int value = values_[previous_index].load(std::memory_order_relaxed);
+			bool odd_pass = pass % 2 == 1;
+			// An odd pass may find a win for an unknown position or a faster win than one through a capture.
+			bool open = value == 0 || (odd_pass && value != kImpossiblePosition && (value - 1) % 2 == 1 && value - 1 > pass);
+			if (!open)
+			{
+				continue;
+			}
+			Evaluate(previous, pass, true, scratch);
+			if (odd_pass && scratch.fastest_win >= 0 && (value == 0 || scratch.fastest_win < value - 1))
+			{
+				SetValue(previous_index, scratch.fastest_win);
+			}
+			else if (!odd_pass && scratch.all_moves_lose)
+			{
+				SetValue(previous_index, scratch.slowest_loss);
+			}
+		}
+	}
+}
+
+/**
+ * Builds one table, whose smaller tables must already be available.
+ *
+ * @param pieces: The table's pieces
+ * @param table: Set to the finished table
+ * @return: True if the table was built, false if a mate is too long to store.
+ */
+bool TablebaseGenerator::Build(const TablebasePieces& pieces, Tablebase& table)
+{
+	pieces_ = pieces;
+	value_count_ = 2 * TablebasePositionCount(pieces);
+	values_.reset(new std::atomic<uint8_t>[value_count_]());
+	max_distance_.store(0);
+	too_long_.store(false);
+
+	ForEachPosition([this](uint64_t index, TablebaseScratch& scratch) { InitializePosition(index, scratch); });
+	// Pass n looks at the positions settled at a distance of n - 1, so it stops once that is beyond the longest mate.
+	for (int pass = 1; pass - 1 <= max_distance_.load() && !too_long_.load(); pass++)
+	{
+		ForEachPosition([this, pass](uint64_t index, TablebaseScratch& scratch) { ResolvePredecessors(index, pass, scratch); });
+	}
+	if (too_long_.load())
+	{
+		values_.reset();
+		return false;
+	}
+	table.SetValues(pieces, values_.get());
+	values_.reset();
+	return true;
+}
+
+/**
+ * Makes a table available in the tablebases, first making sure every smaller table it can reach by a capture
+ * or promotion is there. Each table is read from the directory if its file exists, and otherwise built and saved.
+ *
+ * @param name: The table's name, such as "KRK". The pieces may be given in any order.
+ * @return: True if the table and all the smaller ones are available, false otherwise.
+ */
+bool TablebaseGenerator::Generate(const string& name)
+{
+	string canonical_name = CanonicalTablebaseName(name);
+	TablebasePieces pieces;
+	if (!pieces.FromName(canonical_name))
+	{
+		return false;
+	}
+	if (tablebases_.Find(canonical_name) != nullptr)
+	{
+		return true;
+	}
+	string path = directory_.empty() ? "" : directory_ + "/" + canonical_name + ".tb";
+	unique_ptr<Tablebase> table(new Tablebase());
+	if (!path.empty() && table->Open(path))
+	{
+		tablebases_.Add(std::move(table));
+		return true;
+	}
+
+	for (int i = 2; i < pieces.count; i++)
+	{
+		TablebasePieces smaller = pieces;
+		for (int j = i; j + 1 < pieces.count; j++)
+		{
+			smaller.pieces[j] = pieces.pieces[j + 1];
+		}
+		smaller.count--;
+		if (!Generate(smaller.GetName()))
+		{
+			return false;
+		}
+		if (pieces.pieces[i].GetPiece() == Piece::Pawn)
+		{
+			for (Piece promotion : { Piece::Queen, Piece::Rook, Piece::Bishop, Piece::Knight })
+			{
+				TablebasePieces promoted = pieces;
+				promoted.pieces[i].SetPiece(promotion);
+				if (!Generate(promoted.GetName()))
+				{
+					return false;
+				}
+			}
+		}
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	if (!Build(pieces, *table) || (!path.empty() && !table->Save(path)))
+	{
+		return false;
+	}
+	built_.emplace_back(canonical_name, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+	tablebases_.Add(std::move(table));
+	return true;
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include "Tablebase.h"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+using std::unique_ptr;
+#include <string>
+using std::string;
+#include <utility>
+using std::pair;
+#include <vector>
+using std::vector;
+
+struct TablebaseScratch;
+
+/**
+ * Builds tables by retrograde analysis, using the board's own move generator for every position.
+ *
+ * Every position starts out unknown. The first pass marks the positions that cannot occur, the checkmates, and
+ * the positions decided by a capture or promotion, which are looked up in the smaller tables. Pass n then takes
+ * each position mated or mating in n - 1 plies and unmakes every move that could have led to it. A position
+ * found that way wins in n plies if it has a move to a position lost in n - 1, or is lost in n plies once every
+ * one of its moves reaches a position the opponent is known to win. Whatever is still unknown at the end is a draw.
+ *
+ * Each pass is shared between threads in blocks of positions. While building, each position takes one byte, and
+ * a pass only ever writes wins or only ever writes losses while reading the other, so the threads need no locks.
+ * The byte is the least that will do: a position's distance to mate must be kept until the table is packed, and
+ * a win through a capture may be replaced by a faster one in any later pass, so known and unknown bitmaps with
+ * a frontier per pass could not hold it. What keeps the build small is the numbering, which leaves out the
+ * first and last rank for pawns (see Tablebase).
+ */
+class TablebaseGenerator
+{
+private:
+	Tablebases& tablebases_;
+	string directory_;
+	int thread_count_;
+	vector<pair<string, double>> built_;
+
+	// The table being built and the value of each of its positions, as stored in a table, or 255 if it cannot occur.
+	TablebasePieces pieces_;
+	uint64_t value_count_ = 0;
+	unique_ptr<std::atomic<uint8_t>[]> values_;
+	std::atomic<int> max_distance_{ 0 };
+	std::atomic<bool> too_long_{ false };
+
+	void ForEachPosition(const std::function<void(uint64_t, TablebaseScratch&)>& visit);
+	void InitializePosition(uint64_t index, TablebaseScratch& scratch);
+	void ResolvePredecessors(uint64_t index, int pass, TablebaseScratch& scratch);
+	void Evaluate(const TablebasePosition& position, int pass, bool use_table, TablebaseScratch& scratch);
+	void SetValue(uint64_t index, int distance);
+	bool Build(const TablebasePieces& pieces, Tablebase& table);
+
+public:
+	TablebaseGenerator(Tablebases& tablebases, const string& directory, int thread_count);
+
+	bool Generate(const string& name);
+	// The name of each table built by Generate, in the order they were built, with the seconds each took.
+	const vector<pair<string, double>>& GetBuilt() const { return built_; }
+};
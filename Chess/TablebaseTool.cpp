@@ -0,0 +1,120 @@
+#include "Tablebase.h"
+#include "TablebaseGenerator.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <string>
+using std::string;
+#include <thread>
+
+/**
+ * Builds a table and every smaller table it needs, saving each one in the directory.
+ *
+ * @param name: The table to build, such as "KRK"
+ * @param directory: Where to read and write table files
+ * @param thread_count: The number of threads to build with
+ * @return: True if every table is available, false otherwise.
+ */
+static bool GenerateTables(const string& name, const string& directory, int thread_count)
+{
+	Tablebases tablebases;
+	TablebaseGenerator generator(tablebases, directory, thread_count);
+	bool generated = generator.Generate(name);
+	for (const auto& built : generator.GetBuilt())
+	{
+		const Tablebase* table = tablebases.Find(built.first);
+		cout << "Built " << built.first << ": " << table->GetPositionCount() * 2 << " positions in " << built.second
+			<< " s, longest mate " << table->GetMaxDistance() << " plies" << endl;
+	}
+	if (!generated)
+	{
+		cout << "Could not build " << name << endl;
+	}
+	else if (generator.GetBuilt().empty())
+	{
+		cout << CanonicalTablebaseName(name) << " is already in " << directory << endl;
+	}
+	return generated;
+}
+
+/**
+ * Looks a position up and prints the best line to mate, one move per ply.
+ *
+ * @param directory: Where the table files are
+ * @param fen: The position
+ * @return: True if the position was found, false otherwise.
+ */
+static bool ProbePosition(const string& directory, const string& fen)
+{
+	Tablebases tablebases;
+	int opened = tablebases.Open(directory);
+	ChessBoard chess_board;
+	if (!chess_board.FromFEN(fen.c_str()))
+	{
+		cout << "Could not read the position " << fen << endl;
+		return false;
+	}
+	auto start = std::chrono::steady_clock::now();
+	TablebaseProbe probe = tablebases.Probe(chess_board);
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	switch (probe.result)
+	{
+	case TablebaseResult::NotFound:
+		cout << "The position is not in any of the " << opened << " tables in " << directory << endl;
+		return false;
+	case TablebaseResult::Draw:
+		cout << "Draw";
+		break;
+	case TablebaseResult::Win:
+		cout << chess_board.GetSideToMove() << " mates in " << (probe.distance + 1) / 2;
+		break;
+	case TablebaseResult::Loss:
+		cout << GetOppositeColor(chess_board.GetSideToMove()) << " mates in " << probe.distance / 2;
+		break;
+	}
+	cout << " (looked up in " << seconds * 1e6 << " microseconds)\n";
+
+	if (probe.result != TablebaseResult::Draw)
+	{
+		for (int ply = 0; ply < probe.distance + 1; ply++)
+		{
+			TablebaseProbe line_probe;
+			Move move = tablebases.FindBestMove(chess_board, line_probe);
+			if (move == Move())
+			{
+				break;
+			}
+			cout << move << ' ';
+			chess_board.MakeMove(move);
+		}
+		cout << '\n';
+	}
+	cout.flush();
+	return true;
+}
+
+/**
+ * Builds and reads endgame tablebases.
+ *
+ * Usage:
+ *   tablebase generate <name> [directory] [threads]   Build a table such as KQK, KRK, KPK or KBNK and the smaller ones it needs.
+ *   tablebase probe <directory> <fen>                  Look a position up and print the best line.
+ *
+ * @return: 0 on success, 1 otherwise.
+ */
+int main(int argc, char* argv[])
+{
+	if (argc >= 3 && string(argv[1]) == "generate")
+	{
+		string directory = argc >= 4 ? argv[3] : ".";
+		int thread_count = argc >= 5 ? std::atoi(argv[4]) : static_cast<int>(std::thread::hardware_concurrency());
+		return GenerateTables(argv[2], directory, thread_count) ? 0 : 1;
+	}
+	if (argc >= 4 && string(argv[1]) == "probe")
+	{
+		return ProbePosition(argv[2], argv[3]) ? 0 : 1;
+	}
+	cout << "Usage: tablebase generate <name> [directory] [threads]\n"
+		"       tablebase probe <directory> <fen>" << endl;
+	return 1;
+}
@@ -0,0 +1,247 @@
+#include "TranspositionTable.h"
+
+#include <new>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+// Huge pages are 2 MB on x86-64 Linux and usually the smallest large page size on Windows.
+static const size_t kHugePageSize = size_t(1) << 21;
+
+/**
+ * Packs an entry's fields into its data word. See TTEntry for the layout.
+ *
+ * @return: The data word.
+ */
+static uint64_t PackData(Move move, int score, int depth, Bound bound, uint8_t generation)
+{
+	return uint64_t(move.GetData())
+		| uint64_t(static_cast<uint16_t>(static_cast<int16_t>(score))) << 16
+		| uint64_t(static_cast<uint8_t>(depth)) << 32
+		| uint64_t(bound) << 40
+		| uint64_t(generation) << 42;
+}
+
+static int DataDepth(uint64_t data) { return static_cast<int>((data >> 32) & 255); }
+
+static uint8_t DataGeneration(uint64_t data) { return static_cast<uint8_t>((data >> 42) & 63); }
+
+/**
+ * Maps zeroed memory straight from the operating system. Memory from the system is always page aligned,
+ * which more than covers the cache line alignment of the buckets.
+ *
+ * @param bytes: The number of bytes to allocate
+ * @param use_huge_pages: Try to back the table with huge pages, which saves TLB misses on large tables
+ * @param huge_pages: Set to true if huge pages were actually used
+ * @return: The memory, or nullptr if it could not be allocated.
+ */
+static void* AllocateTable(size_t bytes, bool use_huge_pages, bool& huge_pages)
+{
+	huge_pages = false;
+#ifdef _WIN32
+	if (use_huge_pages && GetLargePageMinimum() != 0 && bytes % GetLargePageMinimum() == 0)
+	{
+		// This needs the "Lock pages in memory" privilege, so falling back to normal pages is the common case.
+		void* memory = VirtualAlloc(nullptr, bytes, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+		if (memory != nullptr)
+		{
+			huge_pages = true;
+			return memory;
+		}
+	}
+	return VirtualAlloc(nullptr, bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#else
+#ifdef MAP_HUGETLB
+	if (use_huge_pages && bytes % kHugePageSize == 0)
+	{
+		// This only succeeds if the administrator has reserved huge pages (vm.nr_hugepages).
+		void* memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+		if (memory != MAP_FAILED)
+		{
+			huge_pages = true;
+			return memory;
+		}
+	}
+#endif
+	void* memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (memory == MAP_FAILED)
+	{
+		return nullptr;
+	}
+#ifdef MADV_HUGEPAGE
+	if (use_huge_pages)
+	{
+		// Otherwise ask for transparent huge pages, which the kernel provides when it can.
+		huge_pages = madvise(memory, bytes, MADV_HUGEPAGE) == 0;
+	}
+#endif
+	return memory;
+#endif
+}
+
+/**
+ * Returns the table's memory to the operating system.
+ *
+ * @return: None
+ */
+void TranspositionTable::Free()
+{
+	if (buckets_ != nullptr)
+	{
+#ifdef _WIN32
+		VirtualFree(buckets_, 0, MEM_RELEASE);
+#else
+		munmap(buckets_, allocated_bytes_);
+#endif
+	}
+	buckets_ = nullptr;
+	bucket_count_ = 0;
+	allocated_bytes_ = 0;
+	huge_pages_ = false;
+}
+
+/**
+ * Replaces the table with an empty one of the given size. The number of buckets is rounded down to a
+ * power of two so that a bucket can be picked with a mask of the hash. Must not be called while a search
+ * is running.
+ *
+ * @param size_mb: The size of the table in megabytes. At least 1.
+ * @param use_huge_pages: Try to back the table with huge pages
+ * @return: True if the memory was allocated, false if the table is left empty.
+ */
+bool TranspositionTable::Resize(size_t size_mb, bool use_huge_pages)
+{
+	Free();
+	size_t bucket_count = 1;
+	while (bucket_count * 2 * sizeof(TTBucket) <= (size_mb > 0 ? size_mb : 1) << 20)
+	{
+		bucket_count *= 2;
+	}
+	size_t bytes = bucket_count * sizeof(TTBucket);
+	void* memory = AllocateTable(bytes, use_huge_pages, huge_pages_);
+	if (memory == nullptr)
+	{
+		return false;
+	}
+	// The memory comes back zeroed, which is an empty table: a zero data word is never stored.
+	buckets_ = new (memory) TTBucket[bucket_count];
+	bucket_count_ = bucket_count;
+	allocated_bytes_ = bytes;
+	return true;
+}
+
+/**
+ * Forgets every stored position, for example before a new game. Must not be called while a search is running.
+ *
+ * @return: None
+ */
+void TranspositionTable::Clear()
+{
+	for (size_t i = 0; i < bucket_count_; i++)
+	{
+		for (TTEntry& entry : buckets_[i].entries)
+		{
+			entry.key.store(0, std::memory_order_relaxed);
+			entry.data.store(0, std::memory_order_relaxed);
+		}
+	}
+	generation_ = 0;
+}
+
+/**
+ * Looks a position up in the table.
+ *
+ * @param hash: The position's Zobrist key
+ * @param tt_data: Filled in with the stored result if the position is found
+ * @return: True if the position was found, false otherwise.
+ */
+bool TranspositionTable::Probe(uint64_t hash, TTData& tt_data) const
+{
+	if (bucket_count_ == 0)
+	{
+		return false;
+	}
+	for (const TTEntry& entry : BucketFor(hash).entries)
+	{
+		uint64_t data = entry.data.load(std::memory_order_relaxed);
+		if (data != 0 && (entry.key.load(std::memory_order_relaxed) ^ data) == hash)
+		{
+			tt_data.move = Move(static_cast<uint16_t>(data));
+			tt_data.score = static_cast<int16_t>(static_cast<uint16_t>(data >> 16));
+			tt_data.depth = DataDepth(data);
+			tt_data.bound = static_cast<Bound>((data >> 40) & 3);
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * Saves a search result. The position's own entry is overwritten if it is already in the bucket;
+ * otherwise the entry replaced is the one least worth keeping, preferring entries from earlier
+ * searches and then the shallowest.
+ *
+ * @param hash: The position's Zobrist key
+ * @param move: The best move found, or an empty move if none
+ * @param score: The score, which must fit in 16 bits
+ * @param depth: The depth searched, from 0 to 255
+ * @param bound: Whether the score is exact or a bound
+ * @return: None
+ */
+void TranspositionTable::Store(uint64_t hash, Move move, int score, int depth, Bound bound)
+{
+	if (bucket_count_ == 0)
+	{
+		return;
+	}
+	TTBucket& bucket = BucketFor(hash);
+	TTEntry* replace = &bucket.entries[0];
+	int replace_worth = 1 << 30;
+	for (TTEntry& entry : bucket.entries)
+	{
+		uint64_t data = entry.data.load(std::memory_order_relaxed);
+		if (data == 0 || (entry.key.load(std::memory_order_relaxed) ^ data) == hash)
+		{
+			// Keep the old best move rather than losing it to a search that did not find one.
+			if (data != 0 && move == Move())
+			{
+				move = Move(static_cast<uint16_t>(data));
+			}
+			replace = &entry;
+			break;
+		}
+		int age = (generation_ - DataGeneration(data)) & 63;
+		int worth = DataDepth(data) - 8 * age;
+		if (worth < replace_worth)
+		{
+			replace_worth = worth;
+			replace = &entry;
+		}
+	}
+	uint64_t data = PackData(move, score, depth, bound, generation_);
+	replace->key.store(hash ^ data, std::memory_order_relaxed);
+	replace->data.store(data, std::memory_order_relaxed);
+}
+
+/**
+ * Samples the start of the table to estimate how full it is, in the units the UCI protocol uses.
+ *
+ * @return: The number of entries from the current search per thousand.
+ */
+int TranspositionTable::GetHashfull() const
+{
+	int used = 0;
+	size_t sample = bucket_count_ < 250 ? bucket_count_ : 250;
+	for (size_t i = 0; i < sample; i++)
+	{
+		for (const TTEntry& entry : buckets_[i].entries)
+		{
+			uint64_t data = entry.data.load(std::memory_order_relaxed);
+			used += data != 0 && DataGeneration(data) == generation_;
+		}
+	}
+	return sample == 0 ? 0 : static_cast<int>(used * 1000 / (sample * 4));
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include "Move.h"
+
+#include <array>
+using std::array;
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+enum class Bound { None, Upper, Lower, Exact };
+
+/**
+ * What the table remembers about a position: the best move found, the score and how deep the search
+ * behind it went. The score is only exact for Exact entries; an Upper bound means every move failed to
+ * beat alpha and a Lower bound means a move reached beta.
+ */
+struct TTData
+{
+	Move move;
+	int score = 0;
+	int depth = 0;
+	Bound bound = Bound::None;
+};
+
+/**
+ * One 16 byte slot of the table. The data word holds the move in bits 0-15, the score in bits 16-31,
+ * the depth in bits 32-39, the bound in bits 40-41 and the search generation in bits 42-47. The key
+ * word holds the position's hash XORed with the data word, so an entry torn by two threads writing
+ * at once no longer matches any position and is simply ignored. No locks are needed.
+ */
+struct TTEntry
+{
+	std::atomic<uint64_t> key;
+	std::atomic<uint64_t> data;
+};
+
+static_assert(sizeof(TTEntry) == 16, "A transposition table entry must pack into 16 bytes");
+
+// Four entries fill a cache line, so a probe touches only one line of memory.
+struct alignas(64) TTBucket
+{
+	array<TTEntry, 4> entries;
+};
+
+/**
+ * A fixed size hash table of search results shared by every search thread. Probes and stores are
+ * lock-free; see TTEntry.
+ */
+class TranspositionTable
+{
+private:
+	TTBucket* buckets_ = nullptr;
+	size_t bucket_count_ = 0;
+	size_t allocated_bytes_ = 0;
+	bool huge_pages_ = false;
+	uint8_t generation_ = 0;
+
+	void Free();
+	TTBucket& BucketFor(uint64_t hash) const { return buckets_[hash & (bucket_count_ - 1)]; }
+
+public:
+	TranspositionTable() = default;
+	TranspositionTable(const TranspositionTable&) = delete;
+	TranspositionTable& operator=(const TranspositionTable&) = delete;
+	~TranspositionTable() { Free(); }
+
+	bool Resize(size_t size_mb, bool use_huge_pages = false);
+	void Clear();
+	// Called at the start of every search so that entries left from earlier searches are replaced first.
+	void NewSearch() { generation_ = (generation_ + 1) & 63; }
+
+	bool Probe(uint64_t hash, TTData& tt_data) const;
+	void Store(uint64_t hash, Move move, int score, int depth, Bound bound);
+
+	size_t GetSizeMB() const { return bucket_count_ * sizeof(TTBucket) >> 20; }
+	bool GetUsesHugePages() const { return huge_pages_; }
+	int GetHashfull() const;
+};
@@ -0,0 +1,352 @@
+#include "ChessGame.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+using std::string;
+#include <thread>
+
+// Time kept back from every move for the pipe and the harness, so that the engine never loses on time.
+const int64_t kMoveOverheadMs = 20;
+// The number of moves the remaining time is shared over when the GUI does not say.
+const int kDefaultMovesToGo = 30;
+
+/**
+ * Writes one or more complete lines to the GUI. Each message is flushed once as a whole, rather than
+ * once per line, and the lock keeps the search thread's output from interleaving with the main thread's.
+ *
+ * @param message: The lines to send, each ending in a newline
+ * @return: None
+ */
+static void Send(const string& message)
+{
+	static std::mutex output_mutex;
+	std::lock_guard<std::mutex> lock(output_mutex);
+	cout << message;
+	cout.flush();
+}
+
+/**
+ * Reads "setoption name <name> [value <value>]". The name runs up to the "value" keyword and the value is
+ * the rest of the line, so either may contain spaces, as file and directory paths often do.
+ *
+ * @param command: The rest of the command line after "setoption"
+ * @param name: Set to the option's name, with the words separated by single spaces
+ * @param value: Set to the value, or an empty string if there is none
+ * @return: None
+ */
+static void ParseSetOption(std::istringstream& command, string& name, string& value)
+{
+	name.clear();
+	value.clear();
+	string token;
+	command >> token;
+	while (command >> token && token != "value")
+	{
+		name += name.empty() ? token : " " + token;
+	}
+	if (token == "value")
+	{
+		std::getline(command >> std::ws, value);
+		// Trailing spaces, and the carriage return of a Windows line ending, are not part of the value.
+		while (!value.empty() && (value.back() == ' ' || value.back() == '\t' || value.back() == '\r'))
+		{
+			value.pop_back();
+		}
+	}
+}
+
+/**
+ * Handles "position startpos [moves ...]" and "position fen <fen> [moves ...]". Moves are in coordinate
+ * notation; reading stops at the first move that is not legal.
+ *
+ * @param game: The game whose board is set up
+ * @param command: The rest of the command line after "position"
+ * @return: None
+ */
+static void SetPosition(ChessGame& game, std::istringstream& command)
+{
+	ChessBoard& chess_board = game.GetBoard();
+	string token;
+	command >> token;
+	if (token == "startpos")
+	{
+		chess_board.Reset();
+		command >> token;
+	}
+	else if (token == "fen")
+	{
+		// The six FEN fields run up to the "moves" keyword or the end of the line.
+		string fen;
+		while (command >> token && token != "moves")
+		{
+			fen += fen.empty() ? token : " " + token;
+		}
+		if (!chess_board.FromFEN(fen.c_str()))
+		{
+			Send("info string could not read the position " + fen + "\n");
+			return;
+		}
+	}
+	else
+	{
+		return;
+	}
+	if (token != "moves")
+	{
+		return;
+	}
+	while (command >> token)
+	{
+		Move move = ParseMove(chess_board, token.c_str());
+		if (move == Move())
+		{
+			Send("info string illegal move " + token + "\n");
+			return;
+		}
+		chess_board.MakeMove(move);
+	}
+}
+
+/**
+ * Works out the search limits from the arguments of a "go" command. A fixed move time or depth is used
+ * as given. With a clock, the engine spends its share of the remaining time over the moves still to
+ * play, plus most of its increment, but never more than half of what is left.
+ *
+ * @param side_to_move: The side the engine is playing
+ * @param command: The rest of the command line after "go"
+ * @param infinite: Set to true for "go infinite", which searches without limits until "stop"
+ * @return: The limits to search with.
+ */
+static SearchLimits ParseGo(Color side_to_move, std::istringstream& command, bool& infinite)
+{
+	infinite = false;
+	SearchLimits limits;
+	int64_t time_left = -1;
+	int64_t increment = 0;
+	int moves_to_go = kDefaultMovesToGo;
+	string token;
+	while (command >> token)
+	{
+		int64_t value = 0;
+		if (token == "wtime" || token == "btime" || token == "winc" || token == "binc"
+			|| token == "movestogo" || token == "movetime" || token == "depth")
+		{
+			command >> value;
+		}
+		bool ours = (token[0] == 'w') == (side_to_move == Color::White);
+		if (token == "infinite")
+		{
+			infinite = true;
+		}
+		else if ((token == "wtime" || token == "btime") && ours)
+		{
+			time_left = value;
+		}
+		else if ((token == "winc" || token == "binc") && ours)
+		{
+			increment = value;
+		}
+		else if (token == "movestogo" && value > 0)
+		{
+			moves_to_go = static_cast<int>(value);
+		}
+		else if (token == "movetime")
+		{
+			limits.move_time_ms = value > kMoveOverheadMs ? value - kMoveOverheadMs : 1;
+		}
+		else if (token == "depth" && value > 0)
+		{
+			limits.max_depth = value < kMaxSearchDepth ? static_cast<int>(value) : kMaxSearchDepth;
+		}
+	}
+	if (infinite)
+	{
+		return SearchLimits();
+	}
+	if (time_left >= 0 && limits.move_time_ms == 0)
+	{
+		int64_t budget = time_left / moves_to_go + increment * 3 / 4;
+		if (budget > time_left / 2)
+		{
+			budget = time_left / 2;
+		}
+		budget -= kMoveOverheadMs;
+		limits.move_time_ms = budget > 1 ? budget : 1;
+	}
+	return limits;
+}
+
+/**
+ * Formats a search result as an "info" line followed by the "bestmove" line.
+ *
+ * @param result: The result of the search
+ * @return: The two lines.
+ */
+static string FormatResult(const SearchResult& result)
+{
+	std::ostringstream out;
+	out << "info depth " << result.depth << " score ";
+	// Tablebase mates may be further from the root than the search itself goes.
+	if (result.score >= kMateScore - kMaxSearchDepth * 2)
+	{
+		out << "mate " << (kMateScore - result.score + 1) / 2;
+	}
+	else if (result.score <= -kMateScore + kMaxSearchDepth * 2)
+	{
+		out << "mate " << -(kMateScore + result.score) / 2;
+	}
+	else
+	{
+		out << "cp " << result.score;
+	}
+	out << " nodes " << result.nodes << " time " << result.time_ms
+		<< " nps " << (result.time_ms > 0 ? result.nodes * 1000 / result.time_ms : result.nodes) << '\n';
+	// A null move is how UCI says there is no legal move.
+	if (result.best_move == Move())
+	{
+		out << "bestmove 0000\n";
+	}
+	else
+	{
+		out << "bestmove " << result.best_move << '\n';
+	}
+	return out.str();
+}
+
+/**
+ * Speaks the Universal Chess Interface over standard input and output, so that GUIs and match harnesses
+ * can drive the engine. Searches run on a background thread, so "stop", "isready" and "quit" are answered
+ * while the engine is thinking.
+ *
+ * Supported commands: uci, isready, setoption name Hash|Threads value N, setoption name BookFile value <file>,
+ * setoption name TablebasePath value <directory>, setoption name EvalFile value <file>, ucinewgame,
+ * position startpos|fen <fen> [moves ...], go [wtime btime winc binc movestogo movetime depth infinite], stop, quit.
+ *
+ * @return: 0
+ */
+int main()
+{
+	std::ios::sync_with_stdio(false);
+	ChessGame game;
+	std::thread search;
+	// An infinite search holds its "bestmove" back until "stop" or "quit", even if it finishes first.
+	std::mutex stop_mutex;
+	std::condition_variable stop_signal;
+	bool stop_received = true;
+	// Waits for the search to end and report its move. An infinite search is stopped, which is what "stop"
+	// asks for, and a command that needs the board in the middle of one can only mean the same.
+	auto wait_for_search = [&]()
+	{
+		if (search.joinable())
+		{
+			{
+				std::lock_guard<std::mutex> lock(stop_mutex);
+				if (!stop_received)
+				{
+					stop_received = true;
+					game.Stop();
+				}
+			}
+			stop_signal.notify_all();
+			search.join();
+		}
+	};
+
+	string line;
+	while (std::getline(std::cin, line))
+	{
+		std::istringstream command(line);
+		string token;
+		command >> token;
+		if (token == "uci")
+		{
+			Send("id name Chess\n"
+				"id author Chess contributors\n"
+				"option name Hash type spin default " + std::to_string(kDefaultHashMB) + " min 1 max 65536\n"
+				"option name Threads type spin default 1 min 1 max 256\n"
+				"option name BookFile type string default <empty>\n"
+				"option name TablebasePath type string default <empty>\n"
+				"option name EvalFile type string default <empty>\n"
+				"uciok\n");
+		}
+		else if (token == "isready")
+		{
+			Send("readyok\n");
+		}
+		else if (token == "setoption")
+		{
+			string name, value;
+			ParseSetOption(command, name, value);
+			wait_for_search();
+			if (name == "Hash")
+			{
+				game.SetHashSize(std::atoi(value.c_str()));
+			}
+			else if (name == "Threads")
+			{
+				game.SetThreads(std::atoi(value.c_str()));
+			}
+			else if (name == "BookFile")
+			{
+				// An empty value or a file that cannot be opened turns the book off.
+				game.OpenBook(value);
+			}
+			else if (name == "TablebasePath")
+			{
+				game.OpenTablebases(value);
+			}
+			else if (name == "EvalFile")
+			{
+				// An empty value or a file that cannot be read goes back to the built in evaluation.
+				game.LoadNetwork(value);
+			}
+		}
+		else if (token == "ucinewgame")
+		{
+			wait_for_search();
+			game.NewGame();
+		}
+		else if (token == "position")
+		{
+			wait_for_search();
+			SetPosition(game, command);
+		}
+		else if (token == "go")
+		{
+			wait_for_search();
+			bool infinite;
+			SearchLimits limits = ParseGo(game.GetBoard().GetSideToMove(), command, infinite);
+			stop_received = !infinite;
+			// The search is started here rather than on the new thread, so that a "stop" read straight after
+			// this always reaches it.
+			game.StartSearch(limits);
+			search = std::thread([&]()
+			{
+				SearchResult result = game.FinishSearch();
+				std::unique_lock<std::mutex> lock(stop_mutex);
+				stop_signal.wait(lock, [&]() { return stop_received; });
+				lock.unlock();
+				Send(FormatResult(result));
+			});
+		}
+		else if (token == "stop")
+		{
+			game.Stop();
+			wait_for_search();
+		}
+		else if (token == "quit")
+		{
+			game.Stop();
+			break;
+		}
+	}
+	// If the input simply ends, the search in progress is allowed to finish and report its move, unless it is
+	// an infinite search, which is stopped.
+	wait_for_search();
+	return 0;
+}
@@ -0,0 +1,60 @@
+#include "Zobrist.h"
+
+/**
+ * Advances a SplitMix64 generator and returns its next output. The same seed always gives the
+ * same keys, so a position's key is stable between runs and can be stored in files.
+ *
+ * @param state: The generator state, which is updated
+ * @return: The next 64-bit random number.
+ */
+static constexpr uint64_t NextRandom(uint64_t& state)
+{
+	state += 0x9E3779B97F4A7C15ULL;
+	uint64_t result = state;
+	result = (result ^ (result >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	result = (result ^ (result >> 27)) * 0x94D049BB133111EBULL;
+	return result ^ (result >> 31);
+}
+
+/**
+ * Fills in every Zobrist key. Castling keys are built from one number per right so that the key of
+ * a mask is the XOR of the keys of its rights.
+ *
+ * @return: The filled in keys.
+ */
+static constexpr ZobristKeys MakeZobristKeys()
+{
+	ZobristKeys keys;
+	uint64_t state = 0x5EED0F2AB1E5ULL;
+	for (auto& color_keys : keys.pieces)
+	{
+		for (auto& piece_keys : color_keys)
+		{
+			for (auto& key : piece_keys)
+			{
+				key = NextRandom(state);
+			}
+		}
+	}
+	keys.black_to_move = NextRandom(state);
+
+	uint64_t right_keys[4] = { NextRandom(state), NextRandom(state), NextRandom(state), NextRandom(state) };
+	for (int rights = 0; rights < 16; rights++)
+	{
+		for (int right = 0; right < 4; right++)
+		{
+			if (rights & (1 << right))
+			{
+				keys.castling[rights] ^= right_keys[right];
+			}
+		}
+	}
+
+	for (auto& key : keys.en_passant)
+	{
+		key = NextRandom(state);
+	}
+	return keys;
+}
+
+constexpr ZobristKeys kZobristKeys = MakeZobristKeys();
@@ -0,0 +1,51 @@
+#pragma once
+#include "ChessPiece.h"
+
+#include <array>
+using std::array;
+#include <cstdint>
+
+// Bits of a castling rights mask, as returned by ChessBoard::GetCastlingRights.
+const int kWhiteKingSide = 1;
+const int kWhiteQueenSide = 2;
+const int kBlackKingSide = 4;
+const int kBlackQueenSide = 8;
+
+/**
+ * The random numbers that make up a position's Zobrist key. A position's key is the XOR of the
+ * number for every piece on its square, the side to move, the castling rights and the en passant file,
+ * so a move only needs to XOR in and out the few numbers it changes.
+ */
+struct ZobristKeys
+{
+	// Indexed by ColorIndex, then Piece, then square.
+	array<array<array<uint64_t, 64>, 7>, 2> pieces{};
+	// XORed in when black is to move.
+	uint64_t black_to_move = 0;
+	// Indexed by the castling rights mask.
+	array<uint64_t, 16> castling{};
+	// Indexed by the column of the en passant square.
+	array<uint64_t, 8> en_passant{};
+};
+
+extern const ZobristKeys kZobristKeys;
+
+inline uint64_t PieceKey(Color color, Piece piece, int square)
+{
+	return kZobristKeys.pieces[ColorIndex(color)][static_cast<int>(piece)][square];
+}
+
+inline uint64_t CastlingKey(int castling_rights)
+{
+	return kZobristKeys.castling[castling_rights];
+}
+
+inline uint64_t EnPassantKey(int square)
+{
+	return kZobristKeys.en_passant[square % 8];
+}
+
+inline uint64_t SideKey()
+{
+	return kZobristKeys.black_to_move;
+}
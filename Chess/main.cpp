@@ -1,6 +1,17 @@
 #include "ChessPiece.h"
 #include "ChessBoard.h"
 #include "ChessPlayer.h"
+#include "ChessGame.h"
+#include "BoardRenderer.h"
+#include "MoveGen.h"
+
+#include <cstdlib>
+#include <filesystem>
+#include <sstream>
+#include <thread>
+
+// How long the computer player may think about each move.
+const int64_t kComputerMoveTimeMs = 100;
 
 /**
  * Prompts the user for coordinates of the piece they'd like to move and
@@ -25,55 +36,250 @@ pair<pair<int, int>, pair<int, int>> GetStartAndEnd()
 	return std::make_pair(start, end);
 }
 
-int main()
+/**
+ * Prompts the player until they give a legal move. Castling is entered as the king's move, and a pawn
+ * reaching the last rank asks which piece it becomes.
+ *
+ * @param chess_board: The position, with the player to move
+ * @return: The legal move.
+ */
+Move GetPlayerMove(const ChessBoard& chess_board)
 {
+	MoveList move_list;
+	GenerateLegalMoves(chess_board, move_list);
+	for (;;)
+	{
+		auto coord_pairs = GetStartAndEnd();
+		if (!cin)
+		{
+			// The input has run out, as at the end of a script.
+			std::exit(0);
+		}
+		pair<int, int> start = coord_pairs.first;
+		pair<int, int> end = coord_pairs.second;
+		if (start.first < 0 || start.first > 7 || start.second < 0 || start.second > 7
+			|| end.first < 0 || end.first > 7 || end.second < 0 || end.second > 7)
+		{
+			cout << "Rows and columns go from 0 to 7" << endl;
+			continue;
+		}
+		// Is the player moving one of their own pieces?
+		if (chess_board.GetPieceAt(SquareOf(start)).GetColor() != chess_board.GetSideToMove())
+		{
+			cout << "Please move one of your own pieces" << endl;
+			continue;
+		}
+
+		// Only moves in the legal move list are allowed, so a pinned piece cannot move off its line and a
+		// player in check must get out of it.
+		Move found;
+		for (Move move : move_list)
+		{
+			if (move.GetStart() == SquareOf(start) && move.GetEnd() == SquareOf(end))
+			{
+				found = move;
+				break;
+			}
+		}
+		if (found == Move())
+		{
+			cout << "Please move your piece to a valid spot" << endl;
+			continue;
+		}
+		if (found.GetType() != MoveType::Promotion)
+		{
+			return found;
+		}
+		for (;;)
+		{
+			char piece;
+			cout << "Give the piece to promote to (q, r, b or n)." << endl;
+			cin >> piece;
+			if (!cin)
+			{
+				std::exit(0);
+			}
+			string text = { static_cast<char>('a' + start.second), static_cast<char>('8' - start.first),
+				static_cast<char>('a' + end.second), static_cast<char>('8' - end.first), piece };
+			Move move = ParseMove(chess_board, text.c_str());
+			if (move != Move())
+			{
+				return move;
+			}
+		}
+	}
+}
+
+/**
+ * Asks the user whether one side should be played by the computer.
+ *
+ * @return: The color the computer plays, or Empty for a two player game.
+ */
+Color GetComputerColor()
+{
+	int choice;
+	cout << "Enter 0 for two players, 1 for the computer to play black or 2 for the computer to play white." << endl;
+	cin >> choice;
+	switch (choice)
+	{
+	case 1:
+		return Color::Black;
+	case 2:
+		return Color::White;
+	default:
+		return Color::Empty;
+	}
+}
+
+/**
+ * Tells the player about a check given by the move just played.
+ *
+ * @param renderer: Where the message is printed
+ * @param chess_board: The board after the move
+ * @param color: The color that just moved
+ * @return: None
+ */
+void AnnounceCheck(BoardRenderer& renderer, ChessBoard& chess_board, Color color)
+{
+	if (chess_board.players_[GetOppositeColor(color)].GetIsInCheck())
+	{
+		renderer.Message("Check!");
+	}
+}
+
+/**
+ * Tells the player when the tablebases know how the game ends from here.
+ *
+ * @param renderer: Where the message is printed
+ * @param game: The game, with the board after the move
+ * @return: None
+ */
+void AnnounceTablebaseResult(BoardRenderer& renderer, ChessGame& game)
+{
+	ChessBoard& chess_board = game.GetBoard();
+	TablebaseProbe probe = game.GetTablebases().Probe(chess_board);
+	std::ostringstream message;
+	switch (probe.result)
+	{
+	case TablebaseResult::Draw:
+		message << "The tablebases say this is a draw.";
+		break;
+	case TablebaseResult::Win:
+		message << chess_board.GetSideToMove() << " mates in " << (probe.distance + 1) / 2 << ".";
+		break;
+	case TablebaseResult::Loss:
+		message << GetOppositeColor(chess_board.GetSideToMove()) << " mates in " << probe.distance / 2 << ".";
+		break;
+	default:
+		return;
+	}
+	renderer.Message(message.str().c_str());
+}
+
+/**
+ * Usage:
+ *   chess [diff|quiet] [book file] [tablebase directory]
+ *
+ * By default the whole board is redrawn after every move. "diff" keeps the board at the top of the
+ * terminal and only redraws the squares that change, and "quiet" only prints the prompts and the replies to
+ * them, for playing from a script. Given a Polyglot opening book, the computer plays its opening moves from
+ * the book. Given a directory of tablebases (see the tablebase tool), the computer plays perfectly once few
+ * enough pieces are left, and the result is announced after every move.
+ */
+int main(int argc, char* argv[])
+{
+	RenderMode mode = RenderMode::Full;
+	vector<string> paths;
+	for (int i = 1; i < argc; i++)
+	{
+		string argument = argv[i];
+		if (argument == "diff")
+		{
+			mode = RenderMode::Diff;
+		}
+		else if (argument == "quiet")
+		{
+			mode = RenderMode::Quiet;
+		}
+		else
+		{
+			paths.push_back(argument);
+		}
+	}
+	BoardRenderer renderer(mode);
 	vector<Color> colors = { Color::White, Color::Black };
-	ChessBoard my_board;
+	ChessGame game;
+	game.SetThreads(static_cast<int>(std::thread::hardware_concurrency()));
+	for (const string& path : paths)
+	{
+		if (std::filesystem::is_directory(path) ? game.OpenTablebases(path) == 0 : !game.OpenBook(path))
+		{
+			cout << "Could not open an opening book or tablebases at " << path << endl;
+		}
+	}
+	ChessBoard& my_board = game.GetBoard();
+	Color computer_color = GetComputerColor();
 	// Set the board to be as it would at the beginning of a chess game and then print it.
 	my_board.Reset();
-	my_board.PrintBoard();
-	auto players = my_board.players_;
+	renderer.Draw(my_board);
 	Color losing_color = Color::Empty;
 	bool game_active = true;
 
-	// While both players still have their kings
+	// While the player to move still has a legal move
 	while (game_active)
 	{
 		// Alternate between the two colors of pieces
 		for (Color color : colors)
 		{
-			// Print the color of the player whose turn it is.
-			cout << color << "'s turn" << endl;
-			
-			// Prompt that player to move a piece.
-			auto coord_pairs = GetStartAndEnd();
-
-			// Is the player moving one of their own pieces?
-			while (players[color].GetColor() != my_board.GetBoard().at(coord_pairs.first.first).at(coord_pairs.first.second).GetColor())
-			{
-				cout << "Please move one of your own pieces" << endl;
-				coord_pairs = GetStartAndEnd();
-			}
-
-			// Is the move valid in the first place?
-			while (!CheckValidMove(my_board.GetBoard().at(coord_pairs.first.first).at(coord_pairs.first.second), my_board, coord_pairs.first, coord_pairs.second ))
+			// With no legal moves the player to move has either been checkmated or stalemated.
+			MoveList move_list;
+			GenerateLegalMoves(my_board, move_list);
+			if (move_list.Size() == 0)
 			{
-				cout << "Please move your piece to a valid spot" << endl;
-				coord_pairs = GetStartAndEnd();
+				if (IsInCheck(my_board))
+				{
+					losing_color = color;
+				}
+				else
+				{
+					renderer.Message("Stalemate!");
+				}
+				game_active = false;
+				break;
 			}
 
-			// Is the player trying to move something other than their king while they're in check?
-			if (players[color].GetIsInCheck())
+			// Print the color of the player whose turn it is.
+			std::ostringstream turn;
+			turn << color << "'s turn";
+			renderer.Message(turn.str().c_str());
+			
+			// The computer searches for its move and plays it.
+			if (color == computer_color)
 			{
-				while (my_board.GetBoard().at(coord_pairs.first.first).at(coord_pairs.first.second).GetPiece() != Piece::King)
+				SearchLimits limits;
+				limits.move_time_ms = kComputerMoveTimeMs;
+				SearchResult result = game.FindBestMove(limits);
+				std::ostringstream computer_move;
+				computer_move << "The computer plays " << result.best_move;
+				renderer.Message(computer_move.str().c_str());
+				bool checkmate = MovePiece(my_board, result.best_move, &game.GetTablebases());
+				renderer.Draw(my_board);
+				AnnounceCheck(renderer, my_board, color);
+				AnnounceTablebaseResult(renderer, game);
+				if (checkmate)
 				{
-					cout << "You're in check, you must move your king!" << endl;
-					coord_pairs = GetStartAndEnd();
+					losing_color = GetOppositeColor(color);
+					game_active = false;
+					break;
 				}
+				continue;
 			}
-			// Move the piece and then print the board. If the King was taken, declare the loser.
-			bool checkmate = MovePiece(my_board, coord_pairs.first, coord_pairs.second);
-			my_board.PrintBoard();
+
+			// Prompt that player for a legal move, play it and then print the board. If it is checkmate, declare the loser.
+			bool checkmate = MovePiece(my_board, GetPlayerMove(my_board), &game.GetTablebases());
+			renderer.Draw(my_board);
+			AnnounceCheck(renderer, my_board, color);
+			AnnounceTablebaseResult(renderer, game);
 			if (checkmate)
 			{
 				losing_color = GetOppositeColor(color);
@@ -86,10 +292,10 @@ int main()
 	switch(losing_color)
 	{
 	case Color::White:
-		cout << "Checkmate! The white king has fallen!" << endl;
+		renderer.Message("Checkmate! The white king has fallen!");
 		break;
 	case Color::Black:
-		cout << "Checkmate! The black king has fallen!" << endl;
+		renderer.Message("Checkmate! The black king has fallen!");
 		break;
 	}
 }
\ No newline at end of file